@@ -25,11 +25,15 @@ DEFINES += QT_DEPRECATED_WARNINGS
 
 SOURCES += \
         main.cpp \
+        decimation.cpp \
         form.cpp \
-    parameters.cpp
+        seriespool.cpp
 
 HEADERS += \
+        decimation.h \
         form.h \
-    parameters.h
+        seriespool.h
+
+include(solver/solver.pri)
 
 TRANSLATIONS += HeatEquation_rus.ts
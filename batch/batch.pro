@@ -0,0 +1,20 @@
+#-------------------------------------------------
+#
+# Headless batch runner for parameter sweeps over
+# (nx, nt, profile, method).
+#
+#-------------------------------------------------
+
+QT       -= gui
+
+TARGET = HeatEquationBatch
+TEMPLATE = app
+CONFIG += console c++11 thread
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += \
+        main.cpp
+
+include(../solver/solver.pri)
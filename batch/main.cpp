@@ -0,0 +1,590 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "adaptivesolver.h"
+#include "checkpoint.h"
+#include "exactcache.h"
+#include "framefile.h"
+#include "heat.h"
+#include "parameters.h"
+#include "profiler.h"
+#include "scalarsolver.h"
+#include "solver.h"
+#include "spectral.h"
+
+struct Case
+{
+    std::int64_t nx, nt;
+    InitialProfile profile;
+    MethodType method;
+    Precision precision;
+};
+
+struct Settings
+{
+    int threads;
+    double tolerance;
+    bool spectral;
+    std::string frames;       // directory for frame files, empty: none
+    std::int64_t every;
+    FramePrecision precision;
+    std::string checkpoints;  // directory for checkpoints, empty: none
+    std::int64_t checkpoint_every;
+    bool resume;
+    std::int64_t monitor;     // divergence check interval in steps, 0: none
+};
+
+struct Result
+{
+    double t;
+    std::int64_t steps;
+    std::int64_t rejected;    // adaptive steps that failed the error test
+    std::int64_t solves;      // scheme updates computed, the work of the run
+    ErrorNorms norms;
+    double seconds;
+    const char *status;       // ok, unstable (rejected before stepping) or diverged
+};
+
+static void usage(const char *argv0)
+{
+    std::fprintf(stderr,
+                 "Usage: %s [options]\n"
+                 "  --nx LIST       number of spatial points (default 257)\n"
+                 "  --nt LIST       number of time steps (default 1000)\n"
+                 "  --profile LIST  gauss, supergauss, rectangle, delta or all (default all)\n"
+                 "  --method LIST   explicit, implicit, cn or all (default all)\n"
+                 "  --precision LIST\n"
+                 "                  double, float (float state and arithmetic), mixed (float\n"
+                 "                  state, double stencil and Thomas sweeps) or all (default\n"
+                 "                  double); float and mixed cases run serial fixed steps.\n"
+                 "                  Several precisions add an accuracy report to stderr\n"
+                 "  --jobs N        number of cases run concurrently (default: hardware concurrency)\n"
+                 "  --threads N     threads used inside each case (default 1)\n"
+                 "  --tolerance TOL adaptive steps for implicit and cn with rtol = atol = TOL,\n"
+                 "                  nt only sets the initial step (default: fixed steps)\n"
+                 "  --reference R   exact (analytic, infinite domain) or spectral (exact for the\n"
+                 "                  grid with fixed ends) solution the norms compare to (default exact)\n"
+                 "  --output FILE   write CSV to FILE instead of stdout\n"
+                 "  --frames DIR    stream every N-th state of fixed-step runs to\n"
+                 "                  DIR/NX_NT_PROFILE_METHOD.heat\n"
+                 "  --every N       frame interval in steps for --frames (default 1)\n"
+                 "  --float32       store frames in single precision\n"
+                 "  --checkpoint DIR\n"
+                 "                  checkpoint fixed-step runs to DIR/NX_NT_PROFILE_METHOD.ckpt\n"
+                 "  --checkpoint-every N\n"
+                 "                  checkpoint interval in steps (default 1000)\n"
+                 "  --resume        continue runs from the checkpoints found in DIR\n"
+                 "  --monitor N     stop fixed-step runs whose peak grows past 3x the initial\n"
+                 "                  one, checked every N steps (default: no check)\n"
+                 "  --timings       print time per step of every solver phase to stderr\n"
+                 "  --counters      --timings plus cycles, instructions and cache misses\n"
+                 "                  (Linux perf events)\n"
+                 "\n"
+                 "CSV columns: steps counts accepted time steps, rejected the adaptive steps\n"
+                 "that failed the error test, solves the scheme updates computed (one per\n"
+                 "fixed step, three per attempted adaptive step); compare work by solves.\n"
+                 "\n"
+                 "Fixed-step cases amplifying some Fourier mode at their alpha are not run\n"
+                 "and reported with status 'unstable'.\n"
+                 "\n"
+                 "Integer LIST items are comma separated and may be ranges:\n"
+                 "  a:b     a, a+1, ..., b\n"
+                 "  a:b:s   a, a+s, ..., b\n"
+                 "  a:b:*f  a, a*f, a*f*f, ..., b\n",
+                 argv0);
+}
+
+static std::vector<std::string> split(const std::string &str, char sep)
+{
+    std::vector<std::string> res;
+    std::string::size_type begin = 0, end;
+    while ((end = str.find(sep, begin)) != std::string::npos)
+    {
+        res.push_back(str.substr(begin, end-begin));
+        begin = end + 1;
+    }
+    res.push_back(str.substr(begin));
+    return res;
+}
+
+static std::vector<std::int64_t> parseIntList(const std::string &spec)
+{
+    std::vector<std::int64_t> res;
+    for (const std::string &item: split(spec, ','))
+    {
+        std::vector<std::string> range = split(item, ':');
+        if (range.size() == 1)
+        {
+            res.push_back(std::stoll(range[0]));
+            continue;
+        }
+        if (range.size() > 3)
+            throw std::invalid_argument("bad range '" + item + "'");
+
+        std::int64_t from = std::stoll(range[0]);
+        std::int64_t to = std::stoll(range[1]);
+        if (range.size() == 3 && !range[2].empty() && range[2][0] == '*')
+        {
+            double factor = std::stod(range[2].substr(1));
+            if (factor <= 1.0 || from <= 0)
+                throw std::invalid_argument("bad geometric range '" + item + "'");
+            for (double v = from; v <= to + 1e-9; v *= factor)
+                res.push_back(static_cast<std::int64_t>(v + 0.5));
+        }
+        else
+        {
+            std::int64_t step = (range.size() == 3) ? std::stoll(range[2]) : 1;
+            if (step <= 0)
+                throw std::invalid_argument("bad range step '" + item + "'");
+            for (std::int64_t v = from; v <= to; v += step)
+                res.push_back(v);
+        }
+    }
+    return res;
+}
+
+static std::vector<InitialProfile> parseProfiles(const std::string &spec)
+{
+    const InitialProfile all[] = {InitialProfile::Gauss, InitialProfile::SuperGauss, InitialProfile::Rectangle, InitialProfile::Delta};
+
+    std::vector<InitialProfile> res;
+    for (const std::string &item: split(spec, ','))
+    {
+        bool found = false;
+        for (InitialProfile profile: all)
+        {
+            if (item == "all" || item == profile_name(profile))
+            {
+                res.push_back(profile);
+                found = true;
+            }
+        }
+        if (!found)
+            throw std::invalid_argument("unknown profile '" + item + "'");
+    }
+    return res;
+}
+
+static std::vector<MethodType> parseMethods(const std::string &spec)
+{
+    const MethodType all[] = {MethodType::Explicit, MethodType::Implicit, MethodType::CrankNicolson};
+
+    std::vector<MethodType> res;
+    for (const std::string &item: split(spec, ','))
+    {
+        bool found = false;
+        for (MethodType method: all)
+        {
+            if (item == "all" || item == method_name(method))
+            {
+                res.push_back(method);
+                found = true;
+            }
+        }
+        if (!found)
+            throw std::invalid_argument("unknown method '" + item + "'");
+    }
+    return res;
+}
+
+static std::vector<Precision> parsePrecisions(const std::string &spec)
+{
+    const Precision all[] = {Precision::Double, Precision::Single, Precision::Mixed};
+
+    std::vector<Precision> res;
+    for (const std::string &item: split(spec, ','))
+    {
+        bool found = false;
+        for (Precision precision: all)
+        {
+            if (item == "all" || item == precision_name(precision))
+            {
+                res.push_back(precision);
+                found = true;
+            }
+        }
+        if (!found)
+            throw std::invalid_argument("unknown precision '" + item + "'");
+    }
+    return res;
+}
+
+static std::string case_name(const Case &c)
+{
+    return std::to_string(c.nx) + "_" + std::to_string(c.nt) + "_" + profile_name(c.profile) + "_" + method_name(c.method);
+}
+
+static bool exists(const std::string &path)
+{
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (file)
+        std::fclose(file);
+    return file != nullptr;
+}
+
+// Cases differing only in the method share their analytic reference
+static ExactCache exact_cache;
+
+static ExactCache::Profile reference(const Case &c, const Parameters &param, double t, bool spectral)
+{
+    if (!spectral)
+        return exact_cache.get(c.nx, t, c.profile, amplitude(c.profile, param.get_dx()));
+
+    SpectralSolver solver(param);
+    solver.init(c.profile);
+    solver.advance_to(t);
+    return std::make_shared<std::vector<double>>(solver.get_state().begin(), solver.get_state().end());
+}
+
+template <typename Solver>
+static void run_scalar(const Case &c, const Parameters &param, const Settings &settings, Result &res)
+{
+    Solver solver(param, c.method);
+    solver.init(c.profile);
+    solver.advance(c.nt);
+    const std::vector<double> state(solver.get_state().begin(), solver.get_state().end());
+    res.t = solver.get_t();
+    res.steps = res.solves = c.nt;
+    res.norms = error_norms(state.data(), reference(c, param, res.t, settings.spectral)->data(), c.nx, param.get_dx());
+}
+
+static Result run(const Case &c, const Settings &settings)
+{
+    Parameters param(c.nx, c.nt, kRangeX, kRangeT);
+    Result res;
+    res.status = "ok";
+    res.rejected = 0;
+
+    auto start = std::chrono::steady_clock::now(), finish = start;
+    if (settings.tolerance > 0.0 && c.method != MethodType::Explicit)
+    {
+        AdaptiveSolver solver(param, c.method, settings.tolerance, settings.tolerance);
+        solver.init(c.profile);
+        solver.advance_to(kRangeT);
+        finish = std::chrono::steady_clock::now();
+        res.t = solver.get_t();
+        res.steps = solver.get_accepted();
+        res.rejected = solver.get_rejected();
+        res.solves = solver.get_solves();
+        res.norms = error_norms(solver.get_state().data(), reference(c, param, res.t, settings.spectral)->data(), c.nx, param.get_dx());
+    }
+    else if (!is_stable(param.get_alpha(), c.method))
+    {
+        res.t = 0.0;
+        res.steps = res.solves = 0;
+        res.norms = ErrorNorms{NAN, NAN, NAN};
+        res.status = "unstable";
+    }
+    else if (c.precision != Precision::Double)
+    {
+        if (c.precision == Precision::Single)
+            run_scalar<FloatSolver>(c, param, settings, res);
+        else
+            run_scalar<MixedSolver>(c, param, settings, res);
+        finish = std::chrono::steady_clock::now();
+    }
+    else
+    {
+        Solver solver(param, c.method);
+        solver.set_threads(settings.threads);
+        solver.set_monitor(settings.monitor);
+        solver.init(c.profile);
+
+        std::unique_ptr<Checkpointer> checkpointer;
+        if (!settings.checkpoints.empty())
+        {
+            const std::string path = settings.checkpoints + "/" + case_name(c) + ".ckpt";
+            if (settings.resume && exists(path))
+                restore(solver, load_checkpoint(path));
+            checkpointer.reset(new Checkpointer(path, settings.checkpoint_every));
+        }
+        std::unique_ptr<FrameWriter> writer;
+        if (!settings.frames.empty())
+        {
+            writer.reset(new FrameWriter(settings.frames + "/" + case_name(c) + ".heat", param, c.profile, c.method,
+                                         settings.every, settings.precision));
+            writer->write(0, solver.get_state().data());
+        }
+
+        // Bulk steps, stopping on every frame, checkpoint and monitor boundary
+        while (solver.get_step() < c.nt)
+        {
+            std::int64_t steps = c.nt - solver.get_step();
+            if (writer)
+                steps = std::min(steps, settings.every - solver.get_step() % settings.every);
+            if (checkpointer)
+                steps = std::min(steps, settings.checkpoint_every - solver.get_step() % settings.checkpoint_every);
+            if (settings.monitor > 0)
+                steps = std::min(steps, settings.monitor - solver.get_step() % settings.monitor);
+
+            solver.advance(steps);
+            if (solver.has_diverged())
+            {
+                res.status = "diverged";
+                break;
+            }
+            if (writer)
+                writer->write(solver.get_step(), solver.get_state().data());
+            if (checkpointer)
+                checkpointer->update(solver);
+        }
+        if (writer)
+            writer->close();
+        if (checkpointer)
+            checkpointer->flush();
+        finish = std::chrono::steady_clock::now();
+        res.t = solver.get_t();
+        res.steps = res.solves = solver.get_step();
+        res.norms = error_norms(solver.get_state().data(), reference(c, param, res.t, settings.spectral)->data(), c.nx, param.get_dx());
+    }
+    res.seconds = std::chrono::duration<double>(finish - start).count();
+    return res;
+}
+
+// Per method and precision: the worst L2 error of the cases that ran, how far
+// it moved from the double precision run of the same case, and the time
+// relative to double over those case pairs
+static void accuracy_report(const std::vector<Case> &cases, const std::vector<Result> &results)
+{
+    const MethodType methods[] = {MethodType::Explicit, MethodType::Implicit, MethodType::CrankNicolson};
+    const Precision precisions[] = {Precision::Double, Precision::Single, Precision::Mixed};
+
+    std::fprintf(stderr, "%-10s %-10s %6s %14s %14s %10s\n", "method", "precision", "cases", "worst l2", "vs double", "speedup");
+    for (MethodType method: methods)
+    {
+        for (Precision precision: precisions)
+        {
+            std::size_t count = 0;
+            double worst = 0.0, shift = 0.0, seconds = 0.0, double_seconds = 0.0;
+            for (std::size_t i = 0; i < cases.size(); ++i)
+            {
+                const Case &c = cases[i];
+                if (c.method != method || c.precision != precision || std::strcmp(results[i].status, "ok") != 0)
+                    continue;
+                ++count;
+                worst = std::max(worst, results[i].norms.l2);
+                for (std::size_t j = 0; j < cases.size(); ++j)
+                {
+                    const Case &d = cases[j];
+                    if (d.nx == c.nx && d.nt == c.nt && d.profile == c.profile && d.method == c.method
+                            && d.precision == Precision::Double && std::strcmp(results[j].status, "ok") == 0)
+                    {
+                        shift = std::max(shift, std::abs(results[i].norms.l2 - results[j].norms.l2));
+                        seconds += results[i].seconds;
+                        double_seconds += results[j].seconds;
+                    }
+                }
+            }
+            if (count == 0)
+                continue;
+            std::fprintf(stderr, "%-10s %-10s %6zu %14.6e %14.6e %10.2f\n", method_name(method), precision_name(precision),
+                         count, worst, shift, seconds > 0.0 ? double_seconds / seconds : 0.0);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::string nx_spec = "257", nt_spec = "1000", profile_spec = "all", method_spec = "all", precision_spec = "double";
+    std::string output;
+    bool timings = false, counters = false;
+    int jobs = static_cast<int>(std::thread::hardware_concurrency());
+    Settings settings = {1, 0.0, false, std::string(), 1, FramePrecision::Float64, std::string(), 1000, false, 0};
+
+    std::vector<Case> cases;
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "-h" || arg == "--help")
+            {
+                usage(argv[0]);
+                return 0;
+            }
+            if (arg == "--float32")
+            {
+                settings.precision = FramePrecision::Float32;
+                continue;
+            }
+            if (arg == "--resume")
+            {
+                settings.resume = true;
+                continue;
+            }
+            if (arg == "--timings" || arg == "--counters")
+            {
+                timings = true;
+                counters = counters || arg == "--counters";
+                continue;
+            }
+            if (i+1 >= argc)
+                throw std::invalid_argument("missing value for '" + arg + "'");
+
+            std::string value = argv[++i];
+            if (arg == "--nx")
+                nx_spec = value;
+            else if (arg == "--nt")
+                nt_spec = value;
+            else if (arg == "--profile")
+                profile_spec = value;
+            else if (arg == "--method")
+                method_spec = value;
+            else if (arg == "--precision")
+                precision_spec = value;
+            else if (arg == "--jobs")
+                jobs = std::stoi(value);
+            else if (arg == "--threads")
+                settings.threads = std::stoi(value);
+            else if (arg == "--tolerance")
+                settings.tolerance = std::stod(value);
+            else if (arg == "--reference")
+            {
+                if (value != "exact" && value != "spectral")
+                    throw std::invalid_argument("unknown reference '" + value + "'");
+                settings.spectral = (value == "spectral");
+            }
+            else if (arg == "--frames")
+                settings.frames = value;
+            else if (arg == "--every")
+            {
+                settings.every = std::stoll(value);
+                if (settings.every < 1)
+                    throw std::invalid_argument("frame interval must be positive");
+            }
+            else if (arg == "--checkpoint")
+                settings.checkpoints = value;
+            else if (arg == "--checkpoint-every")
+            {
+                settings.checkpoint_every = std::stoll(value);
+                if (settings.checkpoint_every < 1)
+                    throw std::invalid_argument("checkpoint interval must be positive");
+            }
+            else if (arg == "--monitor")
+            {
+                settings.monitor = std::stoll(value);
+                if (settings.monitor < 1)
+                    throw std::invalid_argument("monitor interval must be positive");
+            }
+            else if (arg == "--output")
+                output = value;
+            else
+                throw std::invalid_argument("unknown option '" + arg + "'");
+        }
+        if (settings.resume && settings.checkpoints.empty())
+            throw std::invalid_argument("--resume needs --checkpoint");
+        if (settings.resume && !settings.frames.empty())
+            throw std::invalid_argument("--resume cannot append to frame files");
+        const std::vector<Precision> precisions = parsePrecisions(precision_spec);
+        const bool reduced = std::find(precisions.begin(), precisions.end(), Precision::Double) == precisions.end()
+                || precisions.size() > 1;
+        if (reduced && (settings.tolerance > 0.0 || !settings.frames.empty() || !settings.checkpoints.empty() || settings.monitor > 0))
+            throw std::invalid_argument("float and mixed precision do not support --tolerance, --frames, --checkpoint or --monitor");
+
+        for (std::int64_t nx: parseIntList(nx_spec))
+        {
+            if (nx < 3)
+                throw std::invalid_argument("nx must be at least 3");
+            for (std::int64_t nt: parseIntList(nt_spec))
+            {
+                if (nt < 1)
+                    throw std::invalid_argument("nt must be positive");
+                for (InitialProfile profile: parseProfiles(profile_spec))
+                    for (MethodType method: parseMethods(method_spec))
+                        for (Precision precision: precisions)
+                            cases.push_back(Case{nx, nt, profile, method, precision});
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "%s: %s\n", argv[0], e.what());
+        usage(argv[0]);
+        return 1;
+    }
+
+    FILE *out = stdout;
+    if (!output.empty() && !(out = std::fopen(output.c_str(), "w")))
+    {
+        std::fprintf(stderr, "%s: cannot open '%s': %s\n", argv[0], output.c_str(), std::strerror(errno));
+        return 1;
+    }
+
+    std::vector<Result> results(cases.size());
+    std::atomic<size_t> next(0);
+    std::mutex error_mutex;
+    std::string error;
+    auto worker = [&]()
+    {
+        for (size_t i = next++; i < cases.size(); i = next++)
+        {
+            try
+            {
+                results[i] = run(cases[i], settings);
+            }
+            catch (const std::exception &e)
+            {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (error.empty())
+                    error = e.what();
+                next = cases.size();
+            }
+        }
+    };
+
+    if (timings)
+        Profiler::enable(counters);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int k = 1; k < std::max(jobs, 1); ++k)
+        workers.emplace_back(worker);
+    worker();
+    for (auto &thread: workers)
+        thread.join();
+    auto finish = std::chrono::steady_clock::now();
+    Profiler::disable();
+
+    if (!error.empty())
+    {
+        std::fprintf(stderr, "%s: %s\n", argv[0], error.c_str());
+        if (out != stdout)
+            std::fclose(out);
+        return 1;
+    }
+
+    std::fprintf(out, "nx,nt,profile,method,alpha,t,steps,rejected,solves,l1,l2,linf,seconds,status,precision\n");
+    for (size_t i = 0; i < cases.size(); ++i)
+    {
+        const Case &c = cases[i];
+        const Result &r = results[i];
+        Parameters param(c.nx, c.nt, kRangeX, kRangeT);
+        std::fprintf(out, "%" PRId64 ",%" PRId64 ",%s,%s,%.6g,%.6g,%" PRId64 ",%" PRId64 ",%" PRId64 ",%.9g,%.9g,%.9g,%.6e,%s,%s\n",
+                     c.nx, c.nt, profile_name(c.profile), method_name(c.method), param.get_alpha(),
+                     r.t, r.steps, r.rejected, r.solves, r.norms.l1, r.norms.l2, r.norms.linf, r.seconds, r.status, precision_name(c.precision));
+    }
+
+    if (out != stdout)
+        std::fclose(out);
+
+    std::fprintf(stderr, "%zu cases in %.3f s\n", cases.size(), std::chrono::duration<double>(finish - start).count());
+    if (timings)
+        Profiler::print(stderr);
+    if (precision_spec != "double")
+        accuracy_report(cases, results);
+
+    return 0;
+}
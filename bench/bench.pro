@@ -0,0 +1,20 @@
+#-------------------------------------------------
+#
+# Microbenchmarks of the stepping kernels across
+# grid sizes, reported as JSON.
+#
+#-------------------------------------------------
+
+QT       -= gui
+
+TARGET = HeatEquationBench
+TEMPLATE = app
+CONFIG += console c++11 thread release
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += \
+        main.cpp
+
+include(../solver/solver.pri)
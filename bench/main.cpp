@@ -0,0 +1,346 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "heat.h"
+#include "parameters.h"
+#include "scalarsolver.h"
+#include "solver.h"
+#include "tridiagonal.h"
+
+// One timed kernel. run(iterations) performs that many repetitions over nx
+// points; bytes is the minimal memory traffic per point and repetition, used
+// for the effective bandwidth.
+struct Kernel
+{
+    std::string name;
+    double bytes;
+    std::function<void(std::int64_t iterations)> run;
+};
+
+struct Measurement
+{
+    std::string kernel;
+    std::int64_t nx, iterations;
+    double seconds, bytes;
+};
+
+static const char *const kKernels[] = {"explicit", "implicit", "cn", "explicit_float", "implicit_float", "cn_float",
+                                       "explicit_mixed", "implicit_mixed", "cn_mixed", "tdma_forward", "tdma_backward",
+                                       "exact", "dispersion"};
+
+static void usage(const char *argv0)
+{
+    std::fprintf(stderr,
+                 "Usage: %s [options]\n"
+                 "  --nx LIST       comma separated grid sizes\n"
+                 "                  (default 256,1024,4096,16384,65536,262144,1048576,4194304)\n"
+                 "  --kernel LIST   explicit, implicit, cn, their _float and _mixed precision\n"
+                 "                  variants, tdma_forward, tdma_backward, exact, dispersion\n"
+                 "                  or all (default all)\n"
+                 "  --min-time S    minimum measured time per benchmark in seconds (default 0.2)\n"
+                 "  --threads N     threads used inside the solver kernels (default 1)\n"
+                 "  --output FILE   write JSON to FILE instead of stdout\n"
+                 "\n"
+                 "Reports ns per point and step and the effective bandwidth of every\n"
+                 "(kernel, nx) pair; a summary table goes to stderr. dispersion is compute\n"
+                 "bound and reports zero bandwidth.\n",
+                 argv0);
+}
+
+static std::vector<std::string> split(const std::string &str, char sep)
+{
+    std::vector<std::string> res;
+    std::string::size_type begin = 0, end;
+    while ((end = str.find(sep, begin)) != std::string::npos)
+    {
+        res.push_back(str.substr(begin, end-begin));
+        begin = end + 1;
+    }
+    res.push_back(str.substr(begin));
+    return res;
+}
+
+// Parameters with a stable explicit step: alpha = 0.4 on the default domain
+static Parameters stable_parameters(std::int64_t nx)
+{
+    const double dx = kRangeX / (nx-1);
+    const std::int64_t nt = static_cast<std::int64_t>(std::ceil(kRangeT / (0.4*dx*dx)));
+    return Parameters(nx, nt, kRangeX, kRangeT);
+}
+
+// Keeps a result alive so the measured loops are not optimized away
+static volatile double sink;
+
+static MethodType method_of(const std::string &name)
+{
+    if (name.compare(0, 8, "explicit") == 0)
+        return MethodType::Explicit;
+    if (name.compare(0, 8, "implicit") == 0)
+        return MethodType::Implicit;
+    return MethodType::CrankNicolson;
+}
+
+// Float state; the Thomas sweeps stream their intermediate values and
+// factors in the accumulation type, accum_size bytes each
+template <typename Stepper>
+static void make_scalar_kernel(Kernel &kernel, MethodType method, std::int64_t nx, double accum_size)
+{
+    std::shared_ptr<Stepper> solver = std::make_shared<Stepper>(stable_parameters(nx), method);
+    solver->init(InitialProfile::Gauss);
+    kernel.bytes = (method == MethodType::Explicit) ? 8.0 : 8.0 + 4.0*accum_size;
+    kernel.run = [solver](std::int64_t iterations)
+    {
+        solver->advance(iterations);
+        sink = solver->get_state()[solver->get_state().size()/2];
+    };
+}
+
+static Kernel make_kernel(const std::string &name, std::int64_t nx, int threads)
+{
+    Kernel kernel;
+    kernel.name = name;
+
+    if (name == "explicit" || name == "implicit" || name == "cn")
+    {
+        const MethodType method = (name == "explicit") ? MethodType::Explicit
+                : (name == "implicit") ? MethodType::Implicit : MethodType::CrankNicolson;
+        std::shared_ptr<Solver> solver = std::make_shared<Solver>(stable_parameters(nx), method);
+        solver->set_threads(threads);
+        solver->init(InitialProfile::Gauss);
+        // Read and write the state once; the Thomas solves also stream the
+        // factors in the forward and the backward sweep
+        kernel.bytes = (method == MethodType::Explicit) ? 16.0 : 48.0;
+        kernel.run = [solver](std::int64_t iterations)
+        {
+            solver->advance(iterations);
+            sink = solver->get_state()[solver->get_state().size()/2];
+        };
+    }
+    else if (name.size() > 6 && name.compare(name.size()-6, 6, "_float") == 0)
+    {
+        make_scalar_kernel<FloatSolver>(kernel, method_of(name), nx, sizeof(float));
+    }
+    else if (name.size() > 6 && name.compare(name.size()-6, 6, "_mixed") == 0)
+    {
+        make_scalar_kernel<MixedSolver>(kernel, method_of(name), nx, sizeof(double));
+    }
+    else if (name == "tdma_forward" || name == "tdma_backward")
+    {
+        const double alpha = stable_parameters(nx).get_alpha();
+        std::shared_ptr<Tridiagonal> tdma = std::make_shared<Tridiagonal>(nx, alpha, 2.0*alpha+1);
+        std::shared_ptr<std::vector<double>> rhs = std::make_shared<std::vector<double>>(nx, 1.0);
+        std::shared_ptr<std::vector<double>> x = std::make_shared<std::vector<double>>(nx, 0.0);
+        kernel.bytes = 24.0;
+        if (name == "tdma_forward")
+            kernel.run = [tdma, rhs, x, nx](std::int64_t iterations)
+            {
+                const double *r = rhs->data();
+                for (std::int64_t k = 0; k < iterations; ++k)
+                    tdma->forward(r[0], [r](std::size_t i) { return r[i]; }, x->data());
+                sink = (*x)[nx/2];
+            };
+        else
+            kernel.run = [tdma, rhs, x, nx](std::int64_t iterations)
+            {
+                for (std::int64_t k = 0; k < iterations; ++k)
+                    tdma->backward(rhs->data(), (*rhs)[nx-1], x->data());
+                sink = (*x)[nx/2];
+            };
+    }
+    else if (name == "exact")
+    {
+        std::shared_ptr<std::vector<double>> out = std::make_shared<std::vector<double>>(nx);
+        kernel.bytes = 8.0;
+        kernel.run = [out, nx](std::int64_t iterations)
+        {
+            for (std::int64_t k = 0; k < iterations; ++k)
+                exact(nx, 0.5*kRangeT, InitialProfile::Gauss, 1.0, out->data());
+            sink = (*out)[nx/2];
+        };
+    }
+    else if (name == "dispersion")
+    {
+        // nx evaluations spread over the resolved band
+        kernel.bytes = 0.0;
+        kernel.run = [nx](std::int64_t iterations)
+        {
+            double sum = 0.0;
+            for (std::int64_t k = 0; k < iterations; ++k)
+                for (std::int64_t i = 0; i < nx; ++i)
+                    sum += dispersion_diffusion(0.5 * i / nx, 0.4, MethodType::CrankNicolson).second;
+            sink = sum;
+        };
+    }
+    else
+    {
+        throw std::invalid_argument("unknown kernel '" + name + "'");
+    }
+
+    return kernel;
+}
+
+// Grows the iteration count until one run lasts at least min_time, the way
+// Google Benchmark does: after a warm-up run, aim 40% past min_time with
+// at most a tenfold step.
+static Measurement measure(const Kernel &kernel, std::int64_t nx, double min_time)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    kernel.run(1);
+
+    std::int64_t iterations = 1;
+    for (;;)
+    {
+        Clock::time_point start = Clock::now();
+        kernel.run(iterations);
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        if (seconds >= min_time)
+            return Measurement{kernel.name, nx, iterations, seconds, kernel.bytes};
+
+        const double factor = (seconds > 0.0) ? std::min(10.0, 1.4*min_time / seconds) : 10.0;
+        iterations = std::max(iterations + 1, static_cast<std::int64_t>(iterations * factor));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::string nx_spec = "256,1024,4096,16384,65536,262144,1048576,4194304", kernel_spec = "all";
+    std::string output;
+    double min_time = 0.2;
+    int threads = 1;
+
+    std::vector<std::int64_t> sizes;
+    std::vector<std::string> kernels;
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "-h" || arg == "--help")
+            {
+                usage(argv[0]);
+                return 0;
+            }
+            if (i+1 >= argc)
+                throw std::invalid_argument("missing value for '" + arg + "'");
+
+            std::string value = argv[++i];
+            if (arg == "--nx")
+                nx_spec = value;
+            else if (arg == "--kernel")
+                kernel_spec = value;
+            else if (arg == "--min-time")
+                min_time = std::stod(value);
+            else if (arg == "--threads")
+                threads = std::stoi(value);
+            else if (arg == "--output")
+                output = value;
+            else
+                throw std::invalid_argument("unknown option '" + arg + "'");
+        }
+
+        for (const std::string &item: split(nx_spec, ','))
+        {
+            sizes.push_back(std::stoll(item));
+            if (sizes.back() < 3)
+                throw std::invalid_argument("nx must be at least 3");
+        }
+        for (const std::string &item: split(kernel_spec, ','))
+        {
+            bool found = false;
+            for (const char *name: kKernels)
+            {
+                if (item == "all" || item == name)
+                {
+                    kernels.push_back(name);
+                    found = true;
+                }
+            }
+            if (!found)
+                throw std::invalid_argument("unknown kernel '" + item + "'");
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "%s: %s\n", argv[0], e.what());
+        usage(argv[0]);
+        return 1;
+    }
+
+    FILE *out = stdout;
+    if (!output.empty() && !(out = std::fopen(output.c_str(), "w")))
+    {
+        std::fprintf(stderr, "%s: cannot open '%s': %s\n", argv[0], output.c_str(), std::strerror(errno));
+        return 1;
+    }
+
+    std::vector<Measurement> results;
+    std::fprintf(stderr, "%-14s %10s %12s %14s %10s\n", "kernel", "nx", "iterations", "ns/point/step", "GB/s");
+    for (const std::string &name: kernels)
+    {
+        for (std::int64_t nx: sizes)
+        {
+            const Kernel kernel = make_kernel(name, nx, threads);
+            const Measurement m = measure(kernel, nx, min_time);
+            results.push_back(m);
+
+            const double points = double(m.nx) * m.iterations;
+            std::fprintf(stderr, "%-14s %10" PRId64 " %12" PRId64 " %14.3f %10.2f\n", name.c_str(), nx, m.iterations,
+                         m.seconds / points * 1e9, m.bytes * points / m.seconds * 1e-9);
+        }
+    }
+
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+#ifdef NDEBUG
+    const char *build = "release";
+#else
+    const char *build = "debug";
+#endif
+
+    // Same top-level layout as Google Benchmark's JSON reporter
+    std::fprintf(out, "{\n  \"context\": {\n");
+    std::fprintf(out, "    \"date\": \"%s\",\n", date);
+    std::fprintf(out, "    \"executable\": \"%s\",\n", argv[0]);
+    std::fprintf(out, "    \"num_cpus\": %u,\n", std::thread::hardware_concurrency());
+    std::fprintf(out, "    \"threads\": %d,\n", threads);
+    std::fprintf(out, "    \"min_time\": %g,\n", min_time);
+    std::fprintf(out, "    \"library_build_type\": \"%s\"\n", build);
+    std::fprintf(out, "  },\n  \"benchmarks\": [");
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        const Measurement &m = results[i];
+        const double points = double(m.nx) * m.iterations;
+        std::fprintf(out, "%s\n    {\n", i ? "," : "");
+        std::fprintf(out, "      \"name\": \"%s/%" PRId64 "\",\n", m.kernel.c_str(), m.nx);
+        std::fprintf(out, "      \"kernel\": \"%s\",\n", m.kernel.c_str());
+        std::fprintf(out, "      \"nx\": %" PRId64 ",\n", m.nx);
+        std::fprintf(out, "      \"iterations\": %" PRId64 ",\n", m.iterations);
+        std::fprintf(out, "      \"real_time\": %.6e,\n", m.seconds / m.iterations * 1e9);
+        std::fprintf(out, "      \"time_unit\": \"ns\",\n");
+        std::fprintf(out, "      \"ns_per_point_step\": %.6e,\n", m.seconds / points * 1e9);
+        std::fprintf(out, "      \"bytes_per_second\": %.6e\n", m.bytes * points / m.seconds);
+        std::fprintf(out, "    }");
+    }
+    std::fprintf(out, "\n  ]\n}\n");
+
+    if (out != stdout)
+        std::fclose(out);
+
+    return 0;
+}
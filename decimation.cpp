@@ -0,0 +1,36 @@
+#include "decimation.h"
+
+#include <algorithm>
+
+void decimate_minmax(const double *y, std::size_t n, std::size_t buckets, std::vector<std::size_t> &index)
+{
+    index.clear();
+    if (buckets == 0 || n <= 2*buckets + 2)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+            index.push_back(i);
+        return;
+    }
+
+    // Both ends are kept so the curve spans the full axis
+    index.push_back(0);
+    for (std::size_t b = 0; b < buckets; ++b)
+    {
+        const std::size_t first = 1 + (n-2) * b / buckets;
+        const std::size_t last = 1 + (n-2) * (b+1) / buckets;
+
+        std::size_t lo = first, hi = first;
+        for (std::size_t i = first + 1; i < last; ++i)
+        {
+            if (y[i] < y[lo])
+                lo = i;
+            if (y[i] > y[hi])
+                hi = i;
+        }
+
+        index.push_back(std::min(lo, hi));
+        if (lo != hi)
+            index.push_back(std::max(lo, hi));
+    }
+    index.push_back(n-1);
+}
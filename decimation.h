@@ -0,0 +1,14 @@
+#ifndef DECIMATION_H
+#define DECIMATION_H
+
+#include <cstddef>
+#include <vector>
+
+// Reduces a uniformly sampled curve for drawing. The n samples are split into
+// `buckets` runs of consecutive nodes and every run contributes its minimum
+// and maximum in their original order, so narrow peaks survive and the result
+// holds at most 2*buckets + 2 points with both ends. Curves that already fit
+// pass through whole. index receives the kept indices in increasing order.
+void decimate_minmax(const double *y, std::size_t n, std::size_t buckets, std::vector<std::size_t> &index);
+
+#endif // DECIMATION_H
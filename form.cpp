@@ -1,107 +1,5 @@
 #include "form.h"
 
-#include <complex>
-
-static double initial(double x, Form::InitialProfile profile, double ampl = 1.0)
-{
-    switch (profile)
-    {
-    case Form::Gauss:
-        return ampl * std::exp(-std::pow(x / (0.1*kRangeX), 2.0));
-    case Form::SuperGauss:
-        return ampl * std::exp(-std::pow(x / (0.1*kRangeX), 8.0));
-    case Form::Rectangle:
-        return ampl * ((std::abs(x) < 0.1*kRangeX) ? 1.0 : 0.0);
-    case Form::Delta:
-        return ampl * ((std::abs(x) < 1e-10*kRangeX) ? 1.0 : 0.0);
-    default:
-        return 0;
-    }
-}
-
-static std::pair<double, double> dispersion_diffusion(double q_N, double alpha, Form::MethodType type)
-{
-    std::complex<double> lambda;
-    double kappa = 2.0*M_PI*q_N;
-    switch (type)
-    {
-    case Form::Explicit:
-        lambda = 1.0 - 2.0 * alpha * (1.0 - std::cos(kappa));
-        break;
-    case Form::Implicit:
-        lambda = 1.0 / (1.0 + 2.0 * alpha * (1.0 - std::cos(kappa)));
-        break;
-    case Form::CrankNicolson:
-        lambda = (1.0 - alpha * (1.0 - std::cos(kappa))) / (1.0 + alpha * (1.0 - std::cos(kappa)));
-        break;
-    default:
-        lambda = 1.0;
-        break;
-    }
-
-    lambda = std::log(lambda);
-
-    return std::make_pair(std::imag(lambda), -std::real(lambda));
-}
-
-static std::vector<double> exact(int n, double t, Form::InitialProfile profile, double ampl)
-{
-    std::vector<double> res(n);
-    if (t == 0)
-    {
-        for (int i = 0; i < n; ++i)
-        {
-            double xi = (double(i) - n/2) / n * kRangeX;
-            res[i] = initial(xi, profile, ampl);
-        }
-    }
-    else
-    {
-        switch (profile)
-        {
-            case Form::Gauss:
-            {
-                double r0 = 0.1 * kRangeX;
-                for (int i = 0; i < n; ++i)
-                {
-                    double xi = (double(i) - n/2) / n * kRangeX;
-                    res[i] = r0 * std::sqrt(M_PI) / 4.0 / t / std::sqrt(r0*r0 + 4.0*t) * std::exp(-xi*xi / (r0*r0 + 4.0*t));
-                }
-                break;
-            }
-            case Form::SuperGauss:
-            {
-                for (int i = 0; i < n; ++i)
-                {
-                    double xi = (double(i) - n/2) / n * kRangeX;
-                    res[i] = 0.0;
-                }
-                break;
-            }
-            case Form::Rectangle:
-            {
-                for (int i = 0; i < n; ++i)
-                {
-                    double xi = (double(i) - n/2) / n * kRangeX;
-                    res[i] = std::sqrt(M_PI) / 8.0 / t * (std::erf((0.1*kRangeX - xi) / 2.0 / std::sqrt(t)) + std::erf((0.1*kRangeX + xi) / 2.0 / std::sqrt(t)));
-                }
-                break;
-            }
-            case Form::Delta:
-            {
-                for (int i = 0; i < n; ++i)
-                {
-                    double xi = (double(i) - n/2) / n * kRangeX;
-                    res[i] = 1.0 / 8.0 / std::pow(t, 1.5) * std::exp(-xi*xi / 4.0 / t);
-                }
-                break;
-            }
-        }
-    }
-
-    return res;
-}
-
 static void setGrid(QValueAxis* ax)
 {
     ax->setGridLineVisible(true);
@@ -112,10 +10,12 @@ static void setGrid(QValueAxis* ax)
 }
 
 Form::Form(QWidget *parent)
-    : QWidget(parent), param_(nullptr), t_cur_(0.0)
+    : QWidget(parent), param_(nullptr), solver_(nullptr), worker_(nullptr), seriesLive_(nullptr), dst_(nullptr),
+      timings_(qEnvironmentVariableIsSet("HEAT_TIMINGS")), counters_(qgetenv("HEAT_TIMINGS") == "counters")
 {
+    // The solver runs on its own thread, the timer only repaints at display rate
     timer = new QTimer();
-    timer->setInterval(10);
+    timer->setInterval(16);
 
     seriesInitial = new QLineSeries();
     seriesInitial->setColor(Qt::blue);
@@ -157,6 +57,31 @@ Form::Form(QWidget *parent)
     seriesCrankNicolsonDissipation->setColor(Qt::red);
     seriesCrankNicolsonDissipation->setPen(QPen(seriesCrankNicolsonDissipation->pen().brush(), 3));
 
+    spectrumExplicitDispersion = new QLineSeries();
+    spectrumExplicitDispersion->setColor(Qt::lightGray);
+    spectrumExplicitDissipation = new QLineSeries();
+    spectrumExplicitDissipation->setColor(Qt::lightGray);
+    spectrumImplicitDispersion = new QLineSeries();
+    spectrumImplicitDispersion->setColor(Qt::lightGray);
+    spectrumImplicitDissipation = new QLineSeries();
+    spectrumImplicitDissipation->setColor(Qt::lightGray);
+    spectrumCrankNicolsonDispersion = new QLineSeries();
+    spectrumCrankNicolsonDispersion->setColor(Qt::lightGray);
+    spectrumCrankNicolsonDissipation = new QLineSeries();
+    spectrumCrankNicolsonDissipation->setColor(Qt::lightGray);
+    seriesExplicitMeasuredDissipation = new QScatterSeries();
+    seriesExplicitMeasuredDissipation->setColor(Qt::darkGreen);
+    seriesExplicitMeasuredDissipation->setBorderColor(Qt::darkGreen);
+    seriesExplicitMeasuredDissipation->setMarkerSize(5.0);
+    seriesImplicitMeasuredDissipation = new QScatterSeries();
+    seriesImplicitMeasuredDissipation->setColor(Qt::darkGreen);
+    seriesImplicitMeasuredDissipation->setBorderColor(Qt::darkGreen);
+    seriesImplicitMeasuredDissipation->setMarkerSize(5.0);
+    seriesCrankNicolsonMeasuredDissipation = new QScatterSeries();
+    seriesCrankNicolsonMeasuredDissipation->setColor(Qt::darkGreen);
+    seriesCrankNicolsonMeasuredDissipation->setBorderColor(Qt::darkGreen);
+    seriesCrankNicolsonMeasuredDissipation->setMarkerSize(5.0);
+
     seriesExplicitIdealDispersion->append(QList<QPointF>() << QPointF(0.0, 0.0) << QPointF(0.5, 0.0));
     seriesImplicitIdealDispersion->append(QList<QPointF>() << QPointF(0.0, 0.0) << QPointF(0.5, 0.0));
     seriesCrankNicolsonIdealDispersion->append(QList<QPointF>() << QPointF(0.0, 0.0) << QPointF(0.5, 0.0));
@@ -186,10 +111,10 @@ Form::Form(QWidget *parent)
 
     labelInitial = new QLabel(tr("Temperature profile"));
     comboBoxInitial = new QComboBox();
-    comboBoxInitial->addItem(tr("Gauss"), QVariant(Gauss));
-    comboBoxInitial->addItem(tr("SuperGauss"), QVariant(SuperGauss));
-    comboBoxInitial->addItem(tr("Rectangle"), QVariant(Rectangle));
-    comboBoxInitial->addItem(tr("Delta"), QVariant(Delta));
+    comboBoxInitial->addItem(tr("Gauss"), QVariant::fromValue(InitialProfile::Gauss));
+    comboBoxInitial->addItem(tr("SuperGauss"), QVariant::fromValue(InitialProfile::SuperGauss));
+    comboBoxInitial->addItem(tr("Rectangle"), QVariant::fromValue(InitialProfile::Rectangle));
+    comboBoxInitial->addItem(tr("Delta"), QVariant::fromValue(InitialProfile::Delta));
 
     labelSizeX_1 = new QLabel(tr("Grid size"));
     labelSizeX_2 = new QLabel(tr(" L = "));
@@ -208,7 +133,7 @@ Form::Form(QWidget *parent)
     labelSizeT = new QLabel(QString::number(kRangeT, 'f', 1));
 
     sliderNX = new QSlider(Qt::Horizontal);
-    sliderNX->setRange(1, 4);
+    sliderNX->setRange(1, static_cast<int>(std::round(std::log2(kNxMax))) - 4);
     sliderNX->setSingleStep(1);
     sliderNX->setPageStep(1);
     sliderNX->setTickInterval(1);
@@ -253,7 +178,7 @@ Form::Form(QWidget *parent)
     widgetExplicit = new QWidget();
 
     QChart *explicitDispersionChart = new QChart();
-    //explicitDispersionChart->addSeries(spectrumExplicitDispersion);
+    explicitDispersionChart->addSeries(spectrumExplicitDispersion);
     explicitDispersionChart->addSeries(seriesExplicitIdealDispersion);
     explicitDispersionChart->addSeries(seriesExplicitDispersion);
     explicitDispersionChart->setTitle(tr("Dispersion"));
@@ -269,11 +194,13 @@ Form::Form(QWidget *parent)
     explicitDispersionChart->addAxis(axisXExplicitDispersion, Qt::AlignBottom);
     seriesExplicitIdealDispersion->attachAxis(axisXExplicitDispersion);
     seriesExplicitDispersion->attachAxis(axisXExplicitDispersion);
-    //QValueAxis *axisSpectrumXExplicitDispersion = new QValueAxis;
-    //axisSpectrumXExplicitDispersion->setLineVisible(false);
-    //axisSpectrumXExplicitDispersion->setLabelsVisible(false);
-    //explicitDispersionChart->addAxis(axisSpectrumXExplicitDispersion, Qt::AlignBottom);
-    //spectrumExplicitDispersion->attachAxis(axisSpectrumXExplicitDispersion);
+    QValueAxis *axisSpectrumXExplicitDispersion = new QValueAxis;
+    axisSpectrumXExplicitDispersion->setLineVisible(false);
+    axisSpectrumXExplicitDispersion->setLabelsVisible(false);
+    axisSpectrumXExplicitDispersion->setGridLineVisible(false);
+    axisSpectrumXExplicitDispersion->setRange(0.0, 0.5);
+    explicitDispersionChart->addAxis(axisSpectrumXExplicitDispersion, Qt::AlignBottom);
+    spectrumExplicitDispersion->attachAxis(axisSpectrumXExplicitDispersion);
     QValueAxis *axisYExplicitDispersion = new QValueAxis;
     axisYExplicitDispersion->setLineVisible(false);
     setGrid(axisYExplicitDispersion);
@@ -284,16 +211,23 @@ Form::Form(QWidget *parent)
     explicitDispersionChart->addAxis(axisYExplicitDispersion, Qt::AlignLeft);
     seriesExplicitIdealDispersion->attachAxis(axisYExplicitDispersion);
     seriesExplicitDispersion->attachAxis(axisYExplicitDispersion);
-    //spectrumExplicitDispersion->attachAxis(axisYExplicitDispersion);
+    QValueAxis *axisSpectrumYExplicitDispersion = new QValueAxis;
+    axisSpectrumYExplicitDispersion->setLineVisible(false);
+    axisSpectrumYExplicitDispersion->setLabelsVisible(false);
+    axisSpectrumYExplicitDispersion->setGridLineVisible(false);
+    axisSpectrumYExplicitDispersion->setRange(0.0, 1.05);
+    explicitDispersionChart->addAxis(axisSpectrumYExplicitDispersion, Qt::AlignRight);
+    spectrumExplicitDispersion->attachAxis(axisSpectrumYExplicitDispersion);
 
     explicitDispersion = new QChartView();
     explicitDispersion->setRenderHint(QPainter::Antialiasing);
     explicitDispersion->setChart(explicitDispersionChart);
 
     QChart *explicitDissipationChart = new QChart();
-    //explicitDissipationChart->addSeries(spectrumExplicitDissipation);
+    explicitDissipationChart->addSeries(spectrumExplicitDissipation);
     explicitDissipationChart->addSeries(seriesExplicitIdealDissipation);
     explicitDissipationChart->addSeries(seriesExplicitDissipation);
+    explicitDissipationChart->addSeries(seriesExplicitMeasuredDissipation);
     explicitDissipationChart->setTitle(tr("Dissipation"));
     explicitDissipationChart->legend()->hide();
 
@@ -307,11 +241,14 @@ Form::Form(QWidget *parent)
     explicitDissipationChart->addAxis(axisXExplicitDissipation, Qt::AlignBottom);
     seriesExplicitIdealDissipation->attachAxis(axisXExplicitDissipation);
     seriesExplicitDissipation->attachAxis(axisXExplicitDissipation);
-    //QValueAxis *axisSpectrumXExplicitDissipation = new QValueAxis;
-    //axisSpectrumXExplicitDissipation->setLineVisible(false);
-    //axisSpectrumXExplicitDissipation->setLabelsVisible(false);
-    //explicitDissipationChart->addAxis(axisSpectrumXExplicitDissipation, Qt::AlignBottom);
-    //spectrumExplicitDissipation->attachAxis(axisSpectrumXExplicitDissipation);
+    seriesExplicitMeasuredDissipation->attachAxis(axisXExplicitDissipation);
+    QValueAxis *axisSpectrumXExplicitDissipation = new QValueAxis;
+    axisSpectrumXExplicitDissipation->setLineVisible(false);
+    axisSpectrumXExplicitDissipation->setLabelsVisible(false);
+    axisSpectrumXExplicitDissipation->setGridLineVisible(false);
+    axisSpectrumXExplicitDissipation->setRange(0.0, 0.5);
+    explicitDissipationChart->addAxis(axisSpectrumXExplicitDissipation, Qt::AlignBottom);
+    spectrumExplicitDissipation->attachAxis(axisSpectrumXExplicitDissipation);
     QValueAxis *axisYExplicitDissipation = new QValueAxis;
     axisYExplicitDissipation->setLineVisible(false);
     setGrid(axisYExplicitDissipation);
@@ -322,7 +259,14 @@ Form::Form(QWidget *parent)
     explicitDissipationChart->addAxis(axisYExplicitDissipation, Qt::AlignLeft);
     seriesExplicitIdealDissipation->attachAxis(axisYExplicitDissipation);
     seriesExplicitDissipation->attachAxis(axisYExplicitDissipation);
-    //spectrumExplicitDissipation->attachAxis(axisYExplicitDissipation);
+    seriesExplicitMeasuredDissipation->attachAxis(axisYExplicitDissipation);
+    QValueAxis *axisSpectrumYExplicitDissipation = new QValueAxis;
+    axisSpectrumYExplicitDissipation->setLineVisible(false);
+    axisSpectrumYExplicitDissipation->setLabelsVisible(false);
+    axisSpectrumYExplicitDissipation->setGridLineVisible(false);
+    axisSpectrumYExplicitDissipation->setRange(0.0, 1.05);
+    explicitDissipationChart->addAxis(axisSpectrumYExplicitDissipation, Qt::AlignRight);
+    spectrumExplicitDissipation->attachAxis(axisSpectrumYExplicitDissipation);
 
     explicitDissipation = new QChartView();
     explicitDissipation->setRenderHint(QPainter::Antialiasing);
@@ -382,7 +326,7 @@ Form::Form(QWidget *parent)
     widgetImplicit = new QWidget();
 
     QChart *implicitDispersionChart = new QChart();
-    //implicitDispersionChart->addSeries(spectrumImplicitDispersion);
+    implicitDispersionChart->addSeries(spectrumImplicitDispersion);
     implicitDispersionChart->addSeries(seriesImplicitIdealDispersion);
     implicitDispersionChart->addSeries(seriesImplicitDispersion);
     implicitDispersionChart->setTitle(tr("Dispersion"));
@@ -398,11 +342,13 @@ Form::Form(QWidget *parent)
     implicitDispersionChart->addAxis(axisXImplicitDispersion, Qt::AlignBottom);
     seriesImplicitIdealDispersion->attachAxis(axisXImplicitDispersion);
     seriesImplicitDispersion->attachAxis(axisXImplicitDispersion);
-    //QValueAxis *axisSpectrumXImplicitDispersion = new QValueAxis;
-    //axisSpectrumXImplicitDispersion->setLineVisible(false);
-    //axisSpectrumXImplicitDispersion->setLabelsVisible(false);
-    //implicitDispersionChart->addAxis(axisSpectrumXImplicitDispersion, Qt::AlignBottom);
-    //spectrumImplicitDispersion->attachAxis(axisSpectrumXImplicitDispersion);
+    QValueAxis *axisSpectrumXImplicitDispersion = new QValueAxis;
+    axisSpectrumXImplicitDispersion->setLineVisible(false);
+    axisSpectrumXImplicitDispersion->setLabelsVisible(false);
+    axisSpectrumXImplicitDispersion->setGridLineVisible(false);
+    axisSpectrumXImplicitDispersion->setRange(0.0, 0.5);
+    implicitDispersionChart->addAxis(axisSpectrumXImplicitDispersion, Qt::AlignBottom);
+    spectrumImplicitDispersion->attachAxis(axisSpectrumXImplicitDispersion);
     QValueAxis *axisYImplicitDispersion = new QValueAxis;
     axisYImplicitDispersion->setLineVisible(false);
     setGrid(axisYImplicitDispersion);
@@ -413,16 +359,23 @@ Form::Form(QWidget *parent)
     implicitDispersionChart->addAxis(axisYImplicitDispersion, Qt::AlignLeft);
     seriesImplicitIdealDispersion->attachAxis(axisYImplicitDispersion);
     seriesImplicitDispersion->attachAxis(axisYImplicitDispersion);
-    //spectrumImplicitDispersion->attachAxis(axisYImplicitDispersion);
+    QValueAxis *axisSpectrumYImplicitDispersion = new QValueAxis;
+    axisSpectrumYImplicitDispersion->setLineVisible(false);
+    axisSpectrumYImplicitDispersion->setLabelsVisible(false);
+    axisSpectrumYImplicitDispersion->setGridLineVisible(false);
+    axisSpectrumYImplicitDispersion->setRange(0.0, 1.05);
+    implicitDispersionChart->addAxis(axisSpectrumYImplicitDispersion, Qt::AlignRight);
+    spectrumImplicitDispersion->attachAxis(axisSpectrumYImplicitDispersion);
 
     implicitDispersion = new QChartView();
     implicitDispersion->setRenderHint(QPainter::Antialiasing);
     implicitDispersion->setChart(implicitDispersionChart);
 
     QChart *implicitDissipationChart = new QChart();
-    //implicitDissipationChart->addSeries(spectrumImplicitDissipation);
+    implicitDissipationChart->addSeries(spectrumImplicitDissipation);
     implicitDissipationChart->addSeries(seriesImplicitIdealDissipation);
     implicitDissipationChart->addSeries(seriesImplicitDissipation);
+    implicitDissipationChart->addSeries(seriesImplicitMeasuredDissipation);
     implicitDissipationChart->setTitle(tr("Dissipation"));
     implicitDissipationChart->legend()->hide();
 
@@ -436,11 +389,14 @@ Form::Form(QWidget *parent)
     implicitDissipationChart->addAxis(axisXImplicitDissipation, Qt::AlignBottom);
     seriesImplicitIdealDissipation->attachAxis(axisXImplicitDissipation);
     seriesImplicitDissipation->attachAxis(axisXImplicitDissipation);
-    //QValueAxis *axisSpectrumXImplicitDissipation = new QValueAxis;
-    //axisSpectrumXImplicitDissipation->setLineVisible(false);
-    //axisSpectrumXImplicitDissipation->setLabelsVisible(false);
-    //implicitDissipationChart->addAxis(axisSpectrumXImplicitDissipation, Qt::AlignBottom);
-    //spectrumImplicitDissipation->attachAxis(axisSpectrumXImplicitDissipation);
+    seriesImplicitMeasuredDissipation->attachAxis(axisXImplicitDissipation);
+    QValueAxis *axisSpectrumXImplicitDissipation = new QValueAxis;
+    axisSpectrumXImplicitDissipation->setLineVisible(false);
+    axisSpectrumXImplicitDissipation->setLabelsVisible(false);
+    axisSpectrumXImplicitDissipation->setGridLineVisible(false);
+    axisSpectrumXImplicitDissipation->setRange(0.0, 0.5);
+    implicitDissipationChart->addAxis(axisSpectrumXImplicitDissipation, Qt::AlignBottom);
+    spectrumImplicitDissipation->attachAxis(axisSpectrumXImplicitDissipation);
     QValueAxis *axisYImplicitDissipation = new QValueAxis;
     axisYImplicitDissipation->setLineVisible(false);
     setGrid(axisYImplicitDissipation);
@@ -451,7 +407,14 @@ Form::Form(QWidget *parent)
     implicitDissipationChart->addAxis(axisYImplicitDissipation, Qt::AlignLeft);
     seriesImplicitIdealDissipation->attachAxis(axisYImplicitDissipation);
     seriesImplicitDissipation->attachAxis(axisYImplicitDissipation);
-    //spectrumImplicitDissipation->attachAxis(axisYImplicitDissipation);
+    seriesImplicitMeasuredDissipation->attachAxis(axisYImplicitDissipation);
+    QValueAxis *axisSpectrumYImplicitDissipation = new QValueAxis;
+    axisSpectrumYImplicitDissipation->setLineVisible(false);
+    axisSpectrumYImplicitDissipation->setLabelsVisible(false);
+    axisSpectrumYImplicitDissipation->setGridLineVisible(false);
+    axisSpectrumYImplicitDissipation->setRange(0.0, 1.05);
+    implicitDissipationChart->addAxis(axisSpectrumYImplicitDissipation, Qt::AlignRight);
+    spectrumImplicitDissipation->attachAxis(axisSpectrumYImplicitDissipation);
 
     implicitDissipation = new QChartView();
     implicitDissipation->setRenderHint(QPainter::Antialiasing);
@@ -511,7 +474,7 @@ Form::Form(QWidget *parent)
     widgetCrankNicolson = new QWidget();
 
     QChart *crankNicolsonDispersionChart = new QChart();
-    //crankNicolsonDispersionChart->addSeries(spectrumCrankNicolsonDispersion);
+    crankNicolsonDispersionChart->addSeries(spectrumCrankNicolsonDispersion);
     crankNicolsonDispersionChart->addSeries(seriesCrankNicolsonIdealDispersion);
     crankNicolsonDispersionChart->addSeries(seriesCrankNicolsonDispersion);
     crankNicolsonDispersionChart->setTitle(tr("Dispersion"));
@@ -527,11 +490,13 @@ Form::Form(QWidget *parent)
     crankNicolsonDispersionChart->addAxis(axisXCrankNicolsonDispersion, Qt::AlignBottom);
     seriesCrankNicolsonIdealDispersion->attachAxis(axisXCrankNicolsonDispersion);
     seriesCrankNicolsonDispersion->attachAxis(axisXCrankNicolsonDispersion);
-    //QValueAxis *axisSpectrumXCrankNicolsonDispersion = new QValueAxis;
-    //axisSpectrumXCrankNicolsonDispersion->setLineVisible(false);
-    //axisSpectrumXCrankNicolsonDispersion->setLabelsVisible(false);
-    //crankNicolsonDispersionChart->addAxis(axisSpectrumXCrankNicolsonDispersion, Qt::AlignBottom);
-    //spectrumCrankNicolsonDispersion->attachAxis(axisSpectrumXCrankNicolsonDispersion);
+    QValueAxis *axisSpectrumXCrankNicolsonDispersion = new QValueAxis;
+    axisSpectrumXCrankNicolsonDispersion->setLineVisible(false);
+    axisSpectrumXCrankNicolsonDispersion->setLabelsVisible(false);
+    axisSpectrumXCrankNicolsonDispersion->setGridLineVisible(false);
+    axisSpectrumXCrankNicolsonDispersion->setRange(0.0, 0.5);
+    crankNicolsonDispersionChart->addAxis(axisSpectrumXCrankNicolsonDispersion, Qt::AlignBottom);
+    spectrumCrankNicolsonDispersion->attachAxis(axisSpectrumXCrankNicolsonDispersion);
     QValueAxis *axisYCrankNicolsonDispersion = new QValueAxis;
     axisYCrankNicolsonDispersion->setLineVisible(false);
     setGrid(axisYCrankNicolsonDispersion);
@@ -542,16 +507,23 @@ Form::Form(QWidget *parent)
     crankNicolsonDispersionChart->addAxis(axisYCrankNicolsonDispersion, Qt::AlignLeft);
     seriesCrankNicolsonIdealDispersion->attachAxis(axisYCrankNicolsonDispersion);
     seriesCrankNicolsonDispersion->attachAxis(axisYCrankNicolsonDispersion);
-    //spectrumCrankNicolsonDispersion->attachAxis(axisYCrankNicolsonDispersion);
+    QValueAxis *axisSpectrumYCrankNicolsonDispersion = new QValueAxis;
+    axisSpectrumYCrankNicolsonDispersion->setLineVisible(false);
+    axisSpectrumYCrankNicolsonDispersion->setLabelsVisible(false);
+    axisSpectrumYCrankNicolsonDispersion->setGridLineVisible(false);
+    axisSpectrumYCrankNicolsonDispersion->setRange(0.0, 1.05);
+    crankNicolsonDispersionChart->addAxis(axisSpectrumYCrankNicolsonDispersion, Qt::AlignRight);
+    spectrumCrankNicolsonDispersion->attachAxis(axisSpectrumYCrankNicolsonDispersion);
 
     crankNicolsonDispersion = new QChartView();
     crankNicolsonDispersion->setRenderHint(QPainter::Antialiasing);
     crankNicolsonDispersion->setChart(crankNicolsonDispersionChart);
 
     QChart *crankNicolsonDissipationChart = new QChart();
-    //crankNicolsonDissipationChart->addSeries(spectrumCrankNicolsonDissipation);
+    crankNicolsonDissipationChart->addSeries(spectrumCrankNicolsonDissipation);
     crankNicolsonDissipationChart->addSeries(seriesCrankNicolsonIdealDissipation);
     crankNicolsonDissipationChart->addSeries(seriesCrankNicolsonDissipation);
+    crankNicolsonDissipationChart->addSeries(seriesCrankNicolsonMeasuredDissipation);
     crankNicolsonDissipationChart->setTitle(tr("Dissipation"));
     crankNicolsonDissipationChart->legend()->hide();
 
@@ -565,11 +537,14 @@ Form::Form(QWidget *parent)
     crankNicolsonDissipationChart->addAxis(axisXCrankNicolsonDissipation, Qt::AlignBottom);
     seriesCrankNicolsonIdealDissipation->attachAxis(axisXCrankNicolsonDissipation);
     seriesCrankNicolsonDissipation->attachAxis(axisXCrankNicolsonDissipation);
-    //QValueAxis *axisSpectrumXCrankNicolsonDissipation = new QValueAxis;
-    //axisSpectrumXCrankNicolsonDissipation->setLineVisible(false);
-    //axisSpectrumXCrankNicolsonDissipation->setLabelsVisible(false);
-    //crankNicolsonDissipationChart->addAxis(axisSpectrumXCrankNicolsonDissipation, Qt::AlignBottom);
-    //spectrumCrankNicolsonDissipation->attachAxis(axisSpectrumXCrankNicolsonDissipation);
+    seriesCrankNicolsonMeasuredDissipation->attachAxis(axisXCrankNicolsonDissipation);
+    QValueAxis *axisSpectrumXCrankNicolsonDissipation = new QValueAxis;
+    axisSpectrumXCrankNicolsonDissipation->setLineVisible(false);
+    axisSpectrumXCrankNicolsonDissipation->setLabelsVisible(false);
+    axisSpectrumXCrankNicolsonDissipation->setGridLineVisible(false);
+    axisSpectrumXCrankNicolsonDissipation->setRange(0.0, 0.5);
+    crankNicolsonDissipationChart->addAxis(axisSpectrumXCrankNicolsonDissipation, Qt::AlignBottom);
+    spectrumCrankNicolsonDissipation->attachAxis(axisSpectrumXCrankNicolsonDissipation);
     QValueAxis *axisYCrankNicolsonDissipation = new QValueAxis;
     axisYCrankNicolsonDissipation->setLineVisible(false);
     setGrid(axisYCrankNicolsonDissipation);
@@ -580,7 +555,14 @@ Form::Form(QWidget *parent)
     crankNicolsonDissipationChart->addAxis(axisYCrankNicolsonDissipation, Qt::AlignLeft);
     seriesCrankNicolsonIdealDissipation->attachAxis(axisYCrankNicolsonDissipation);
     seriesCrankNicolsonDissipation->attachAxis(axisYCrankNicolsonDissipation);
-    //spectrumCrankNicolsonDissipation->attachAxis(axisYCrankNicolsonDissipation);
+    seriesCrankNicolsonMeasuredDissipation->attachAxis(axisYCrankNicolsonDissipation);
+    QValueAxis *axisSpectrumYCrankNicolsonDissipation = new QValueAxis;
+    axisSpectrumYCrankNicolsonDissipation->setLineVisible(false);
+    axisSpectrumYCrankNicolsonDissipation->setLabelsVisible(false);
+    axisSpectrumYCrankNicolsonDissipation->setGridLineVisible(false);
+    axisSpectrumYCrankNicolsonDissipation->setRange(0.0, 1.05);
+    crankNicolsonDissipationChart->addAxis(axisSpectrumYCrankNicolsonDissipation, Qt::AlignRight);
+    spectrumCrankNicolsonDissipation->attachAxis(axisSpectrumYCrankNicolsonDissipation);
 
     crankNicolsonDissipation = new QChartView();
     crankNicolsonDissipation->setRenderHint(QPainter::Antialiasing);
@@ -637,6 +619,24 @@ Form::Form(QWidget *parent)
     crankNicolsonMain->addLayout(crankNicolsonRight);
     widgetCrankNicolson->setLayout(crankNicolsonMain);
 
+    // Snapshot curves are recycled from fixed pools; the live curve is redrawn
+    // at display rate and goes through OpenGL where available
+    QChart *solutionCharts[3] = {explicitSolutionChart, implicitSolutionChart, crankNicolsonSolutionChart};
+    QChart *errorCharts[3] = {explicitErrorChart, implicitErrorChart, crankNicolsonErrorChart};
+    for (int m = 0; m < 3; ++m)
+    {
+        solutionPools_[m] = new SeriesPool(solutionCharts[m], kSnapshotSeries);
+        errorPools_[m] = new SeriesPool(errorCharts[m], kSnapshotSeries);
+
+        liveSeries_[m] = new QLineSeries();
+        liveSeries_[m]->setColor(Qt::gray);
+        solutionCharts[m]->addSeries(liveSeries_[m]);
+        liveSeries_[m]->attachAxis(solutionCharts[m]->axisX());
+        liveSeries_[m]->attachAxis(solutionCharts[m]->axisY());
+        liveSeries_[m]->setVisible(false);
+        SeriesPool::accelerate(liveSeries_[m]);
+    }
+
     tabWidgetMethods = new QTabWidget();
     tabWidgetMethods->addTab(widgetExplicit, tr("Explicit"));
     tabWidgetMethods->addTab(widgetImplicit, tr("Implicit"));
@@ -695,7 +695,15 @@ Form::Form(QWidget *parent)
 
 Form::~Form()
 {
+    delete worker_;
+    delete solver_;
     delete param_;
+    delete dst_;
+    for (int m = 0; m < 3; ++m)
+    {
+        delete solutionPools_[m];
+        delete errorPools_[m];
+    }
 }
 
 void Form::update_nx_from_slider(int n)
@@ -717,21 +725,20 @@ void Form::update_nx_from_slider(int n)
 
 void Form::update_nx(int n)
 {
-    int old_nx = param_->get_nx();
     if (n == 0)
     {
-        n = std::max(old_nx/2, kNxMin);
+        n = std::max(static_cast<int>(param_->get_nx()-1)/2, kNxMin);
     }
+    n = std::min(std::max(n, kNxMin), kNxMax);
 
     int new_nx_log = static_cast<int>(std::round(std::log2(static_cast<double>(n))));
-    int new_nx = static_cast<int>(std::round(std::pow(2.0, new_nx_log)));
 
     spinBoxNX->blockSignals(true);
     sliderNX->blockSignals(true);
 
     sliderNX->setValue(new_nx_log-4);
-    spinBoxNX->setValue(new_nx);
-    spinBoxNX->setSingleStep(new_nx);
+    spinBoxNX->setValue(n);
+    spinBoxNX->setSingleStep(n);
 
     spinBoxNX->blockSignals(false);
     sliderNX->blockSignals(false);
@@ -765,6 +772,7 @@ void Form::updateLabels()
     labelStepX->setText(QString::number(param_->get_dx(), 'f', 3));
     labelStepT->setText(QString::number(param_->get_dt(), 'f', 3));
     labelAlpha->setText(QString::number(param_->get_alpha(), 'f', 3));
+    labelAlpha->setStyleSheet(is_stable(param_->get_alpha(), method_) ? QString() : QString("color: red"));
 }
 
 void Form::initiateState()
@@ -773,21 +781,15 @@ void Form::initiateState()
     param_ = new Parameters(spinBoxNX->value()+1, spinBoxNT->value(), kRangeX, kRangeT);
 
     profile_ = comboBoxInitial->currentData().value<InitialProfile>();
-    state_.resize(param_->get_nx());
-    tmp_state_.resize(state_.size());
-    tdma_u_.resize(state_.size()-1);
-    tdma_v_.resize(state_.size()-1);
-
-    double ampl = (profile_ == Delta) ? kRangeX*0.1/param_->get_dx() : 1.0;
+    method_ = static_cast<MethodType>(tabWidgetMethods->currentIndex());
 
-    for (decltype(state_.size()) i = 0; i < state_.size(); ++i)
-        state_[i] = initial((double(i) - state_.size()/2) * param_->get_dx(), profile_, ampl);
+    delete solver_;
+    solver_ = new Solver(*param_, method_);
+    solver_->set_monitor(kMonitorEvery);
+    solver_->init(profile_);
 
-    QList<QPointF> init_data;
-    for (decltype(state_.size()) i = 0; i < state_.size(); ++i)
-        init_data.append(QPointF((double(i) - state_.size()/2) * param_->get_dx(), state_[i]));
-    seriesInitial->clear();
-    seriesInitial->append(init_data);
+    const AlignedVector &state = solver_->get_state();
+    seriesInitial->replace(curve(state.data(), state.size(), chartView->chart()));
 
     updateLabels();
     updateDispersionDiffusion();
@@ -805,15 +807,15 @@ void Form::updateDispersionDiffusion()
         double xi = static_cast<double>(i) / (param_->get_nx()-1);
         ideal_diff_data.append(QPointF(xi, xi*xi));
 
-        coeffs = dispersion_diffusion(xi, param_->get_alpha(), Form::Explicit);
+        coeffs = dispersion_diffusion(xi, param_->get_alpha(), MethodType::Explicit);
         explicit_disp_data.append(QPointF(xi, coeffs.first));
         explicit_diff_data.append(QPointF(xi, coeffs.second));
 
-        coeffs = dispersion_diffusion(xi, param_->get_alpha(), Form::Implicit);
+        coeffs = dispersion_diffusion(xi, param_->get_alpha(), MethodType::Implicit);
         implicit_disp_data.append(QPointF(xi, coeffs.first));
         implicit_diff_data.append(QPointF(xi, coeffs.second));
 
-        coeffs = dispersion_diffusion(xi, param_->get_alpha(), Form::CrankNicolson);
+        coeffs = dispersion_diffusion(xi, param_->get_alpha(), MethodType::CrankNicolson);
         crank_nicolson_disp_data.append(QPointF(xi, coeffs.first));
         crank_nicolson_diff_data.append(QPointF(xi, coeffs.second));
     }
@@ -851,21 +853,105 @@ void Form::updateDispersionDiffusion()
 }
 
 void Form::updateSpectrum()
-{}
+{
+    const AlignedVector &state = solver_->get_state();
+    spectrum_ = spectrumOf(state.data(), state.size());
+    showSpectrum(spectrum_, 0);
+}
+
+const std::vector<double> &Form::spectrumOf(const double *state, std::size_t n)
+{
+    if (dst_ == nullptr || dst_->size() != n-2)
+    {
+        delete dst_;
+        dst_ = new SineTransform(n-2);
+    }
+    sine_spectrum(*dst_, state, spectrumWork_, spectrumLive_);
+    return spectrumLive_;
+}
+
+// Sine mode m of the grid sits at ϰ/ϰ_N = m / (2(nx-1)); the magnitudes are
+// scaled by the largest initial one. Comparing with the initial spectrum gives
+// the damping per step every mode actually went through, plotted in the units
+// of the dissipation charts next to the analytic curve.
+void Form::showSpectrum(const std::vector<double> &spectrum, std::int64_t step)
+{
+    double norm = 0.0;
+    for (double c: spectrum_)
+        norm = std::max(norm, std::abs(c));
+    if (norm == 0.0)
+        norm = 1.0;
+
+    const double xi_step = 0.5 / (spectrum.size()+1);
+    QVector<QPointF> data;
+    data.reserve(static_cast<int>(spectrum.size()));
+    for (decltype(spectrum.size()) m = 0; m < spectrum.size(); ++m)
+        data << QPointF((m+1) * xi_step, std::abs(spectrum[m]) / norm);
+
+    if (step == 0)
+    {
+        for (QLineSeries *series: {spectrumExplicitDispersion, spectrumExplicitDissipation, spectrumImplicitDispersion,
+                                   spectrumImplicitDissipation, spectrumCrankNicolsonDispersion, spectrumCrankNicolsonDissipation})
+            series->replace(data);
+        seriesExplicitMeasuredDissipation->clear();
+        seriesImplicitMeasuredDissipation->clear();
+        seriesCrankNicolsonMeasuredDissipation->clear();
+        return;
+    }
+
+    // Modes lost in round-off carry no information about the scheme
+    QVector<QPointF> damping;
+    for (decltype(spectrum.size()) m = 0; m < spectrum.size(); ++m)
+        if (std::abs(spectrum_[m]) > 1e-6*norm && std::abs(spectrum[m]) > 1e-12*norm)
+            damping << QPointF((m+1) * xi_step, -std::log(std::abs(spectrum[m] / spectrum_[m])) / step / (4.0*M_PI*M_PI*param_->get_alpha()));
+
+    switch(method_)
+    {
+    case MethodType::Explicit:
+        spectrumExplicitDispersion->replace(data);
+        spectrumExplicitDissipation->replace(data);
+        seriesExplicitMeasuredDissipation->replace(damping);
+        break;
+    case MethodType::Implicit:
+        spectrumImplicitDispersion->replace(data);
+        spectrumImplicitDissipation->replace(data);
+        seriesImplicitMeasuredDissipation->replace(damping);
+        break;
+    case MethodType::CrankNicolson:
+        spectrumCrankNicolsonDispersion->replace(data);
+        spectrumCrankNicolsonDissipation->replace(data);
+        seriesCrankNicolsonMeasuredDissipation->replace(damping);
+        break;
+    }
+}
 
 void Form::cleanSolution()
 {
-    explicitSolution->chart()->removeAllSeries();
-    implicitSolution->chart()->removeAllSeries();
-    crankNicolsonSolution->chart()->removeAllSeries();
+    seriesLive_ = nullptr;
 
-    explicitError->chart()->removeAllSeries();
-    implicitError->chart()->removeAllSeries();
-    crankNicolsonError->chart()->removeAllSeries();
+    for (int m = 0; m < 3; ++m)
+    {
+        solutionPools_[m]->hide();
+        errorPools_[m]->hide();
+        liveSeries_[m]->clear();
+        liveSeries_[m]->setVisible(false);
+    }
 }
 
 void Form::Solve()
 {
+    initiateState();
+    if (!is_stable(param_->get_alpha(), method_))
+    {
+        QMessageBox::warning(this, tr("Unstable scheme"),
+                             tr("This scheme amplifies the shortest waves at α = %1 and would blow up. "
+                                "Increase NT or decrease NX.").arg(param_->get_alpha(), 0, 'f', 3));
+        return;
+    }
+
+    if (timings_)
+        Profiler::enable(counters_);
+
     pushButtonSolve->setEnabled(false);
     tabWidgetMethods->setEnabled(false);
     comboBoxInitial->setEnabled(false);
@@ -874,90 +960,71 @@ void Form::Solve()
     sliderNX->setEnabled(false);
     sliderNT->setEnabled(false);
 
-    initiateState();
     updateSpectrum();
 
-    showState();
+    Snapshot initial_state;
+    initial_state.step = 0;
+    initial_state.t = solver_->get_t();
+    initial_state.keyframe = true;
+    initial_state.last = false;
+    initial_state.state.assign(solver_->get_state().begin(), solver_->get_state().end());
+    showState(initial_state);
+
+    seriesLive_ = liveSeries_[static_cast<int>(method_)];
+    seriesLive_->setVisible(true);
+
+    delete worker_;
+    worker_ = new SolverWorker(*solver_);
+    // The peak is tracked by the stepping kernels themselves, see Solver::set_monitor()
+    Solver *solver = solver_;
+    worker_->start(kRangeT, kRangeT / 5.0, timer->interval() * 1e-3, [solver](const AlignedVector &)
+    {
+        return solver->has_diverged();
+    });
 
-    t_cur_ = 0.0;
     timer->start();
 }
 
 void Form::Tick()
 {
-    static int t_index = 1;
-
-    if (t_cur_ < kRangeT + 1e-3*param_->get_dt())
+    std::shared_ptr<const Snapshot> snapshot, frame;
+    while ((snapshot = worker_->poll()))
     {
-        t_cur_ += param_->get_dt();
+        if (snapshot->keyframe)
+            showState(*snapshot);
+        else
+            frame = snapshot;
 
-        double inv_denominator;
-        switch (method_)
+        if (snapshot->last)
         {
-        case Explicit:
-            tmp_state_.front() = state_.front();
-            tmp_state_.back() = state_.back();
-            for (decltype(state_.size()) i = 1; i < state_.size()-1; ++i)
-                tmp_state_[i] = state_[i] + param_->get_alpha() * (state_[i+1] - 2.0*state_[i] + state_[i-1]);
-            break;
-        case Implicit:
-            tdma_u_[0] = 0.0;
-            tdma_v_[0] = state_[0];
-            for (decltype(state_.size()) i = 1; i < state_.size()-1; ++i)
-            {
-                inv_denominator = 1.0 / (param_->get_alpha() * tdma_u_[i-1] - (2.0*param_->get_alpha()+1));
-                tdma_u_[i] = -param_->get_alpha() * inv_denominator;
-                tdma_v_[i] = (-state_[i] - param_->get_alpha() * tdma_v_[i-1]) * inv_denominator;
-            }
-            tmp_state_[state_.size()-1] = state_[state_.size()-1];
-            for (decltype(state_.size()) i = state_.size()-2; i > 0; --i)
-                tmp_state_[i] = tdma_u_[i] * tmp_state_[i+1] + tdma_v_[i];
-            tmp_state_[0] = tdma_u_[0] * tmp_state_[1] + tdma_v_[0];
-
-            break;
-        case CrankNicolson:
-            tdma_u_[0] = 0.0;
-            tdma_v_[0] = state_[0];
-            for (decltype(state_.size()) i = 1; i < state_.size()-1; ++i)
-            {
-                inv_denominator = 1.0 / (0.5*param_->get_alpha() * tdma_u_[i-1] - (param_->get_alpha()+1));
-                tdma_u_[i] = -0.5*param_->get_alpha() * inv_denominator;
-                tdma_v_[i] = (-state_[i] - 0.5*param_->get_alpha()*(state_[i+1]-2.0*state_[i]+state_[i-1]) - 0.5*param_->get_alpha() * tdma_v_[i-1]) * inv_denominator;
-            }
-            tmp_state_[state_.size()-1] = state_[state_.size()-1];
-            for (decltype(state_.size()) i = state_.size()-2; i > 0; --i)
-                tmp_state_[i] = tdma_u_[i] * tmp_state_[i+1] + tdma_v_[i];
-            tmp_state_[0] = tdma_u_[0] * tmp_state_[1] + tdma_v_[0];
-
-            break;
-        }
-
-        state_ = tmp_state_;
-
-        if (t_cur_ > kRangeT / 5.0 * t_index)
-        {
-            ++t_index;
-            showState();
-        }
-
-        if (*std::max_element(&state_[0], &state_[static_cast<int>(state_.size()*0.4)]) > 3.0 || *std::min_element(&state_[0], &state_[static_cast<int>(state_.size()*0.4)]) < -3.0)
-        {
-            t_index = 1;
-            showState();
             finishCalculation();
+            return;
         }
     }
-    else
-    {
-        t_index = 1;
 
-        finishCalculation();
-    }
+    // Only the most recent frame is worth drawing
+    if (frame)
+        showLiveState(*frame);
 }
 
 void Form::finishCalculation()
 {
     timer->stop();
+    worker_->stop();
+
+    if (timings_)
+    {
+        Profiler::disable();
+        Profiler::print(stderr);
+    }
+
+    if (seriesLive_)
+    {
+        seriesLive_->clear();
+        seriesLive_->setVisible(false);
+        seriesLive_ = nullptr;
+    }
+
     pushButtonSolve->setEnabled(true);
     tabWidgetMethods->setEnabled(true);
     comboBoxInitial->setEnabled(true);
@@ -967,52 +1034,74 @@ void Form::finishCalculation()
     sliderNT->setEnabled(true);
 }
 
-void Form::showState()
+QChart *Form::solutionChart() const
 {
-    QChart *chartSolution = nullptr;
-    QChart *chartError = nullptr;
     switch(method_)
     {
-    case Explicit:
-        chartSolution = explicitSolution->chart();
-        chartError = explicitError->chart();
-        break;
-    case Implicit:
-        chartSolution = implicitSolution->chart();
-        chartError = implicitError->chart();
-        break;
-    case CrankNicolson:
-        chartSolution = crankNicolsonSolution->chart();
-        chartError = crankNicolsonError->chart();
-        break;
+    case MethodType::Explicit:
+        return explicitSolution->chart();
+    case MethodType::Implicit:
+        return implicitSolution->chart();
+    case MethodType::CrankNicolson:
+        return crankNicolsonSolution->chart();
     }
+    return nullptr;
+}
+
+QChart *Form::errorChart() const
+{
+    switch(method_)
+    {
+    case MethodType::Explicit:
+        return explicitError->chart();
+    case MethodType::Implicit:
+        return implicitError->chart();
+    case MethodType::CrankNicolson:
+        return crankNicolsonError->chart();
+    }
+    return nullptr;
+}
+
+// Curve of a grid function centred on the rod, decimated to about two points
+// per pixel of the chart's plot area
+QVector<QPointF> Form::curve(const double *values, std::size_t n, const QChart *chart)
+{
+    const std::size_t buckets = static_cast<std::size_t>(std::max<double>(chart->plotArea().width(), kCurveBucketsMin));
+    decimate_minmax(values, n, buckets, decimated_);
+
+    QVector<QPointF> data;
+    data.reserve(static_cast<int>(decimated_.size()));
+    for (std::size_t i: decimated_)
+        data << QPointF(((double)i - n/2) * param_->get_dx(), values[i]);
+    return data;
+}
+
+void Form::showState(const Snapshot &snapshot)
+{
+    HEAT_PROFILE(Phase::Plot, 0, snapshot.state.size());
+
+    SeriesPool *poolSolution = solutionPools_[static_cast<int>(method_)];
+    SeriesPool *poolError = errorPools_[static_cast<int>(method_)];
+
+    const std::vector<double> &state = snapshot.state;
+    poolSolution->fade();
+    poolSolution->take()->replace(curve(state.data(), state.size(), solutionChart()));
+
+    ExactCache::Profile data = exact_.get(state.size(), snapshot.t, profile_, amplitude(profile_, param_->get_dx()));
+    poolError->fade();
+    poolError->take()->replace(curve(data->data(), data->size(), errorChart()));
+
+    if (snapshot.step > 0)
+        showSpectrum(spectrumOf(state.data(), state.size()), snapshot.step);
+}
+
+void Form::showLiveState(const Snapshot &snapshot)
+{
+    HEAT_PROFILE(Phase::Plot, 0, snapshot.state.size());
+
+    const std::vector<double> &state = snapshot.state;
+    seriesLive_->replace(curve(state.data(), state.size(), solutionChart()));
 
-    for (auto& series: chartSolution->series())
-        series->setOpacity(0.5);
-
-    QLineSeries *seriesSolution = new QLineSeries();
-    chartSolution->addSeries(seriesSolution);
-    seriesSolution->attachAxis(chartSolution->axisX());
-    seriesSolution->attachAxis(chartSolution->axisY());
-
-    QList<QPointF> dataSolution;
-    dataSolution.reserve(state_.size());
-    for (decltype(state_.size()) i = 0; i < state_.size(); ++i)
-        dataSolution << QPointF(((double)i - state_.size()/2) * param_->get_dx(), state_[i]);
-    seriesSolution->append(dataSolution);
-
-    for (auto& series: chartError->series())
-        series->setOpacity(0.5);
-
-    QLineSeries *seriesError= new QLineSeries();
-    chartError->addSeries(seriesError);
-    seriesError->attachAxis(chartError->axisX());
-    seriesError->attachAxis(chartError->axisY());
-
-    std::vector<double> data = exact(state_.size(), t_cur_, profile_, (profile_ == Delta) ? kRangeX*0.1/param_->get_dx() : 1.0);
-    QList<QPointF> dataError;
-    dataError.reserve(data.size());
-    for (decltype(data.size()) i = 0; i < data.size(); ++i)
-        dataError << QPointF(((double)i - state_.size()/2) * param_->get_dx(), data[i]);
-    seriesError->append(dataError);
+    if (snapshot.step > 0)
+        showSpectrum(spectrumOf(state.data(), state.size()), snapshot.step);
 }
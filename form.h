@@ -1,9 +1,11 @@
 #ifndef FORM_H
 #define FORM_H
 
+#include <algorithm>
 #include <vector>
 
 #include <QComboBox>
+#include <QMessageBox>
 #include <QPushButton>
 #include <QSlider>
 #include <QSpinBox>
@@ -14,14 +16,29 @@
 #include <QtCharts/QtCharts>
 QT_CHARTS_USE_NAMESPACE
 
+#include "decimation.h"
+#include "exactcache.h"
 #include "parameters.h"
+#include "profiler.h"
+#include "seriespool.h"
+#include "solver.h"
+#include "solverworker.h"
+#include "spectral.h"
 
-constexpr double kRangeX = 10.0;
-constexpr double kRangeT = 1.0;
+Q_DECLARE_METATYPE(InitialProfile)
+
+// Limits of the interactive controls only; the solver itself accepts any grid size
 constexpr int kNxMin = 32;
-constexpr int kNxMax = 256;
+constexpr int kNxMax = 65536;
 constexpr int kNtMin = 1;
-constexpr int kNtMax = 1000;
+constexpr int kNtMax = 100000;
+// Snapshot curves kept per chart: the initial state, one every kRangeT/5 and
+// the last state of an aborted run
+constexpr int kSnapshotSeries = 8;
+// Decimation buckets for charts that are not laid out yet
+constexpr double kCurveBucketsMin = 1024;
+// Steps between divergence checks of a running solution
+constexpr std::int64_t kMonitorEvery = 64;
 
 class Form : public QWidget
 {
@@ -31,12 +48,6 @@ public:
     Form(QWidget *parent = 0);
     ~Form();
 
-    enum InitialProfile {Gauss, SuperGauss, Rectangle, Delta};
-    Q_ENUM(InitialProfile)
-
-    enum MethodType {Explicit, Implicit, CrankNicolson};
-    Q_ENUM(MethodType)
-
 private slots:
     void update_nx_from_slider(int log_n);
     void update_nx(int n);
@@ -71,16 +82,39 @@ private:
     QLineSeries *seriesExplicitIdealDissipation, *seriesImplicitIdealDissipation, *seriesCrankNicolsonIdealDissipation;
     QLineSeries *seriesExplicitDispersion, *seriesImplicitDispersion, *seriesCrankNicolsonDispersion;
     QLineSeries *seriesExplicitDissipation, *seriesImplicitDissipation, *seriesCrankNicolsonDissipation;
+    QLineSeries *spectrumExplicitDispersion, *spectrumImplicitDispersion, *spectrumCrankNicolsonDispersion;
+    QLineSeries *spectrumExplicitDissipation, *spectrumImplicitDissipation, *spectrumCrankNicolsonDissipation;
+    QScatterSeries *seriesExplicitMeasuredDissipation, *seriesImplicitMeasuredDissipation, *seriesCrankNicolsonMeasuredDissipation;
 
     QTimer *timer;
 
     MethodType method_;
     InitialProfile profile_;
     Parameters *param_;
-    std::vector<double> state_, tmp_state_, tdma_u_, tdma_v_;
-    double t_cur_;
+    Solver *solver_;
+    SolverWorker *worker_;
+    QLineSeries *seriesLive_;
+    std::vector<double> spectrum_;
+    // Sine transform of the current nx, rebuilt only when nx changes, and
+    // the scratch of the live spectra
+    SineTransform *dst_;
+    std::vector<double> spectrumWork_, spectrumLive_;
+    ExactCache exact_;
+    // Indexed by MethodType
+    SeriesPool *solutionPools_[3], *errorPools_[3];
+    QLineSeries *liveSeries_[3];
+    std::vector<std::size_t> decimated_;
+    // HEAT_TIMINGS set in the environment: per-phase timings of every run go
+    // to stderr, HEAT_TIMINGS=counters adds hardware counters
+    bool timings_, counters_;
 
-    void showState();
+    QChart *solutionChart() const;
+    QChart *errorChart() const;
+    QVector<QPointF> curve(const double *values, std::size_t n, const QChart *chart);
+    void showState(const Snapshot &snapshot);
+    void showLiveState(const Snapshot &snapshot);
+    const std::vector<double> &spectrumOf(const double *state, std::size_t n);
+    void showSpectrum(const std::vector<double> &spectrum, std::int64_t step);
     void finishCalculation();
     void cleanSolution();
 };
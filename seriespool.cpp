@@ -0,0 +1,60 @@
+#include "seriespool.h"
+
+#ifndef QT_NO_OPENGL
+#include <QOpenGLContext>
+#endif
+
+SeriesPool::SeriesPool(QChart *chart, int size)
+    : next_(0)
+{
+    for (int i = 0; i < size; ++i)
+    {
+        QLineSeries *series = new QLineSeries();
+        chart->addSeries(series);
+        series->attachAxis(chart->axisX());
+        series->attachAxis(chart->axisY());
+        series->setVisible(false);
+        series_.append(series);
+    }
+}
+
+QLineSeries *SeriesPool::take()
+{
+    QLineSeries *series = series_[next_];
+    next_ = (next_ + 1) % series_.size();
+
+    series->setOpacity(1.0);
+    series->setVisible(true);
+    return series;
+}
+
+void SeriesPool::fade(const QAbstractSeries *keep)
+{
+    for (QLineSeries *series: series_)
+        if (series != keep && series->isVisible())
+            series->setOpacity(0.5);
+}
+
+void SeriesPool::hide()
+{
+    for (QLineSeries *series: series_)
+    {
+        series->clear();
+        series->setVisible(false);
+    }
+    next_ = 0;
+}
+
+void SeriesPool::accelerate(QXYSeries *series)
+{
+#ifndef QT_NO_OPENGL
+    static const bool available = []()
+    {
+        QOpenGLContext context;
+        return context.create();
+    }();
+    series->setUseOpenGL(available);
+#else
+    Q_UNUSED(series);
+#endif
+}
@@ -0,0 +1,31 @@
+#ifndef SERIESPOOL_H
+#define SERIESPOOL_H
+
+#include <QList>
+
+#include <QtCharts/QtCharts>
+QT_CHARTS_USE_NAMESPACE
+
+// Fixed set of line series attached to one chart once and recycled for the
+// snapshot curves, instead of adding and deleting a series per snapshot.
+// take() hands out the series shown longest ago, so a run with more
+// snapshots than the pool holds keeps the latest ones.
+class SeriesPool
+{
+public:
+    SeriesPool(QChart *chart, int size);
+
+    QLineSeries *take();
+    // Dims every shown series except the one given
+    void fade(const QAbstractSeries *keep = nullptr);
+    void hide();
+
+    // Draws the series through OpenGL when a context can be created
+    static void accelerate(QXYSeries *series);
+
+private:
+    QList<QLineSeries *> series_;
+    int next_;
+};
+
+#endif // SERIESPOOL_H
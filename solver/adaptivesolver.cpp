@@ -0,0 +1,169 @@
+#include "adaptivesolver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Steps are grown only when the error would stay below this fraction of the
+// tolerance after doubling dt
+constexpr double kGrowthSafety = 0.5;
+constexpr int kMinLevel = -40;
+
+AdaptiveSolver::AdaptiveSolver(const Parameters &param, MethodType method, double rtol, double atol)
+    : param_(param), method_(method), rtol_(rtol), atol_(atol), t_cur_(0.0), level_(0), accepted_(0), rejected_(0)
+{
+    if (method_ == MethodType::Explicit)
+        throw std::invalid_argument("adaptive stepping needs the Implicit or Crank-Nicolson scheme");
+
+    state_.resize(param_.get_nx());
+    full_.resize(state_.size());
+    half_.resize(state_.size());
+    tmp_.resize(state_.size());
+}
+
+void AdaptiveSolver::init(InitialProfile profile)
+{
+    double ampl = amplitude(profile, param_.get_dx());
+
+    for (decltype(state_.size()) i = 0; i < state_.size(); ++i)
+        state_[i] = initial((double(i) - state_.size()/2) * param_.get_dx(), profile, ampl);
+
+    t_cur_ = 0.0;
+    level_ = 0;
+    accepted_ = rejected_ = 0;
+}
+
+bool AdaptiveSolver::step(double t_end)
+{
+    const int order = (method_ == MethodType::CrankNicolson) ? 2 : 1;
+    const double scale = 1.0 / ((1 << order) - 1);
+
+    for (;;)
+    {
+        if (t_cur_ >= t_end * (1.0 - 1e-12))
+            return false;
+
+        double dt = std::ldexp(param_.get_dt(), level_);
+        const bool last = (t_cur_ + dt >= t_end);
+        if (last)
+        {
+            // The final step is clipped to t_end and gets its own factors
+            dt = t_end - t_cur_;
+            Tridiagonal full = make_factor(dt), half = make_factor(0.5*dt);
+            advance_once(full, state_, full_);
+            advance_once(half, state_, tmp_);
+            advance_once(half, tmp_, half_);
+        }
+        else
+        {
+            advance_once(level_factor(level_), state_, full_);
+            const Tridiagonal &half = level_factor(level_-1);
+            advance_once(half, state_, tmp_);
+            advance_once(half, tmp_, half_);
+        }
+
+        const double err = scale * error(full_, half_);
+        if (err <= 1.0)
+        {
+            state_.swap(half_);
+            t_cur_ = last ? t_end : t_cur_ + dt;
+            ++accepted_;
+            if (!last && err * (1 << (order+1)) < kGrowthSafety)
+                ++level_;
+            return true;
+        }
+
+        ++rejected_;
+        if (level_ <= kMinLevel)
+            throw std::runtime_error("adaptive step size underflow");
+        --level_;
+    }
+}
+
+void AdaptiveSolver::advance_to(double t_end)
+{
+    while (step(t_end))
+        ;
+}
+
+const Parameters &AdaptiveSolver::get_parameters() const
+{
+    return param_;
+}
+
+MethodType AdaptiveSolver::get_method() const
+{
+    return method_;
+}
+
+const AlignedVector &AdaptiveSolver::get_state() const
+{
+    return state_;
+}
+
+double AdaptiveSolver::get_t() const
+{
+    return t_cur_;
+}
+
+double AdaptiveSolver::get_dt() const
+{
+    return std::ldexp(param_.get_dt(), level_);
+}
+
+std::int64_t AdaptiveSolver::get_accepted() const
+{
+    return accepted_;
+}
+
+std::int64_t AdaptiveSolver::get_rejected() const
+{
+    return rejected_;
+}
+
+std::int64_t AdaptiveSolver::get_solves() const
+{
+    return 3 * (accepted_ + rejected_);
+}
+
+Tridiagonal AdaptiveSolver::make_factor(double dt) const
+{
+    const double alpha = dt / param_.get_dx() / param_.get_dx();
+    if (method_ == MethodType::Implicit)
+        return Tridiagonal(state_.size(), alpha, 2.0*alpha+1);
+    return Tridiagonal(state_.size(), 0.5*alpha, alpha+1);
+}
+
+const Tridiagonal &AdaptiveSolver::level_factor(int level)
+{
+    auto it = factors_.find(level);
+    if (it == factors_.end())
+        it = factors_.insert(std::make_pair(level, make_factor(std::ldexp(param_.get_dt(), level)))).first;
+    return it->second;
+}
+
+void AdaptiveSolver::advance_once(const Tridiagonal &tdma, const AlignedVector &in, AlignedVector &out) const
+{
+    if (method_ == MethodType::Implicit)
+    {
+        tdma.solve(in.data(), out.data());
+        return;
+    }
+
+    const double half_alpha = tdma.get_off();
+    const double *s = in.data();
+    tdma.forward(s[0], [s, half_alpha](std::size_t i) { return s[i] + half_alpha*(s[i+1]-2.0*s[i]+s[i-1]); }, out.data());
+    tdma.backward(out.data(), in.back(), out.data());
+}
+
+double AdaptiveSolver::error(const AlignedVector &coarse, const AlignedVector &fine) const
+{
+    double err = 0.0;
+    for (decltype(fine.size()) i = 0; i < fine.size(); ++i)
+    {
+        double e = std::abs(fine[i] - coarse[i]) / (atol_ + rtol_ * std::abs(fine[i]));
+        if (e > err || std::isnan(e))
+            err = e;
+    }
+    return err;
+}
@@ -0,0 +1,56 @@
+#ifndef ADAPTIVESOLVER_H
+#define ADAPTIVESOLVER_H
+
+#include <cstdint>
+#include <map>
+
+#include "aligned.h"
+#include "heat.h"
+#include "parameters.h"
+#include "tridiagonal.h"
+
+// Error-controlled time stepping for the Implicit and Crank-Nicolson schemes by
+// step doubling: every step of size dt is compared with two steps of dt/2,
+// the difference scaled by 1/(2^p - 1) estimates the local error of the
+// two half steps, which are kept when the weighted error norm
+//     max_i |err_i| / (atol + rtol*|u_i|)
+// is at most one. The step size only moves between levels dt0*2^k (dt0 is
+// the Parameters time step), so the factorized tridiagonal operators are
+// cached per level instead of being rebuilt on every step.
+class AdaptiveSolver
+{
+public:
+    AdaptiveSolver(const Parameters &param, MethodType method, double rtol, double atol);
+
+    void init(InitialProfile profile);
+    // Takes one accepted step without passing t_end; returns false at t_end
+    bool step(double t_end);
+    void advance_to(double t_end);
+
+    const Parameters &get_parameters() const;
+    MethodType get_method() const;
+    const AlignedVector &get_state() const;
+    double get_t() const;
+    double get_dt() const;
+    std::int64_t get_accepted() const;
+    std::int64_t get_rejected() const;
+    // Scheme updates computed, three per attempted step (one full, two half)
+    std::int64_t get_solves() const;
+
+private:
+    Parameters param_;
+    MethodType method_;
+    double rtol_, atol_;
+    AlignedVector state_, full_, half_, tmp_;
+    std::map<int, Tridiagonal> factors_;
+    double t_cur_;
+    int level_;
+    std::int64_t accepted_, rejected_;
+
+    Tridiagonal make_factor(double dt) const;
+    const Tridiagonal &level_factor(int level);
+    void advance_once(const Tridiagonal &tdma, const AlignedVector &in, AlignedVector &out) const;
+    double error(const AlignedVector &coarse, const AlignedVector &fine) const;
+};
+
+#endif // ADAPTIVESOLVER_H
@@ -0,0 +1,232 @@
+#include "adisolver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "gridsolver.h"
+
+// Columns per block of the 2-D y sweep, a cache line of doubles
+constexpr std::size_t kColumnBlock = 8;
+
+AdiSolver::AdiSolver(const std::vector<Parameters> &axes)
+    : axes_(axes), t_cur_(0.0)
+{
+    if (axes_.size() < 2 || axes_.size() > 3)
+        throw std::invalid_argument("AdiSolver needs two or three axes");
+
+    n_.fill(1);
+    alpha_.fill(0.0);
+    for (std::size_t a = 0; a < axes_.size(); ++a)
+    {
+        if (axes_[a].get_nx() < 3)
+            throw std::invalid_argument("every axis needs at least 3 points");
+        if (std::abs(axes_[a].get_dt() - axes_[0].get_dt()) > 1e-12 * axes_[0].get_dt())
+            throw std::invalid_argument("all axes must share the time step");
+        n_[a] = axes_[a].get_nx();
+        alpha_[a] = axes_[a].get_alpha();
+        tdma_[a] = Tridiagonal(n_[a], 0.5*alpha_[a], alpha_[a]+1);
+    }
+
+    state_.resize(n_[0] * n_[1] * n_[2]);
+    tmp_state_.resize(state_.size());
+    tmp2_state_.resize(state_.size());
+}
+
+void AdiSolver::init(InitialProfile profile)
+{
+    init_grid(axes_, profile, state_);
+    // The faces never change, every buffer carries them from here on
+    tmp_state_ = state_;
+    tmp2_state_ = state_;
+
+    t_cur_ = 0.0;
+}
+
+void AdiSolver::step()
+{
+    if (axes_.size() == 2)
+        step_peaceman_rachford();
+    else
+        step_douglas();
+
+    t_cur_ += axes_[0].get_dt();
+}
+
+void AdiSolver::advance(std::int64_t steps)
+{
+    for (std::int64_t k = 0; k < steps; ++k)
+        step();
+}
+
+void AdiSolver::set_threads(int threads)
+{
+    if (threads > 1)
+        pool_.reset(new ThreadPool(threads));
+    else
+        pool_.reset();
+}
+
+int AdiSolver::get_threads() const
+{
+    return pool_ ? pool_->size() : 1;
+}
+
+const std::vector<Parameters> &AdiSolver::get_axes() const
+{
+    return axes_;
+}
+
+const AlignedVector &AdiSolver::get_state() const
+{
+    return state_;
+}
+
+double AdiSolver::get_t() const
+{
+    return t_cur_;
+}
+
+std::size_t AdiSolver::index(std::size_t i, std::size_t j, std::size_t k) const
+{
+    return i + n_[0]*(j + n_[1]*k);
+}
+
+template <typename Job>
+void AdiSolver::parallel(std::size_t count, Job job) const
+{
+    if (!pool_)
+    {
+        job(std::size_t(0), count);
+        return;
+    }
+
+    const std::size_t threads = pool_->size();
+    pool_->run([&](int index)
+    {
+        job(count * index / threads, count * (index+1) / threads);
+    });
+}
+
+void AdiSolver::step_peaceman_rachford()
+{
+    const std::size_t nx = n_[0], ny = n_[1];
+    const double hx = 0.5*alpha_[0], hy = 0.5*alpha_[1];
+    const Tridiagonal &tdma_x = tdma_[0];
+
+    // x sweep: right-hand side (1 + Ay/2) u into tmp_state_, then the rows
+    parallel(ny-2, [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t j = begin+1; j < end+1; ++j)
+        {
+            const double *u = &state_[j*nx];
+            const double *below = u - nx, *above = u + nx;
+            double *d = &tmp_state_[j*nx];
+            for (std::size_t i = 1; i < nx-1; ++i)
+                d[i] = u[i] + hy*(below[i] - 2.0*u[i] + above[i]);
+        }
+        tdma_x.solve_rows(&tmp_state_[(begin+1)*nx], end-begin, nx);
+    });
+
+    // y sweep: right-hand side (1 + Ax/2) u* into state_, then all columns at once
+    parallel(ny-2, [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t j = begin+1; j < end+1; ++j)
+        {
+            const double *s = &tmp_state_[j*nx];
+            double *d = &state_[j*nx];
+            for (std::size_t i = 1; i < nx-1; ++i)
+                d[i] = s[i] + hx*(s[i-1] - 2.0*s[i] + s[i+1]);
+        }
+    });
+    solve_columns(1, state_.data());
+}
+
+void AdiSolver::step_douglas()
+{
+    const std::size_t nx = n_[0], ny = n_[1], nz = n_[2];
+    const std::size_t sy = nx, sz = nx*ny;
+    const double hx = 0.5*alpha_[0], ay = alpha_[1], az = alpha_[2];
+    const Tridiagonal &tdma_x = tdma_[0];
+
+    // x sweep: (1 - Ax/2) u1 = (1 + Ax/2 + Ay + Az) u, one batch of rows per z plane
+    parallel(nz-2, [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t k = begin+1; k < end+1; ++k)
+        {
+            for (std::size_t j = 1; j < ny-1; ++j)
+            {
+                const std::size_t row = nx*(j + ny*k);
+                const double *u = &state_[row];
+                double *d = &tmp_state_[row];
+                for (std::size_t i = 1; i < nx-1; ++i)
+                    d[i] = u[i] + hx*(u[i-1] - 2.0*u[i] + u[i+1]) + ay*(u[i-sy] - 2.0*u[i] + u[i+sy]) + az*(u[i-sz] - 2.0*u[i] + u[i+sz]);
+            }
+            tdma_x.solve_rows(&tmp_state_[nx*(1 + ny*k)], ny-2, nx);
+        }
+    });
+
+    // y sweep: (1 - Ay/2) u2 = u1 - Ay/2 u, right-hand side into tmp2_state_
+    // z sweep: (1 - Az/2) u' = u2 - Az/2 u, right-hand side into tmp_state_
+    for (int axis = 1; axis < 3; ++axis)
+    {
+        const std::size_t s = (axis == 1) ? sy : sz;
+        const double h = 0.5 * alpha_[axis];
+        const double *src = (axis == 1) ? tmp_state_.data() : tmp2_state_.data();
+        double *dst = (axis == 1) ? tmp2_state_.data() : tmp_state_.data();
+        parallel((ny-2)*(nz-2), [&](std::size_t begin, std::size_t end)
+        {
+            for (std::size_t r = begin; r < end; ++r)
+            {
+                const std::size_t row = nx*((1 + r % (ny-2)) + ny*(1 + r / (ny-2)));
+                const double *u = &state_[row];
+                for (std::size_t i = 1; i < nx-1; ++i)
+                    dst[row+i] = src[row+i] - h*(u[i-s] - 2.0*u[i] + u[i+s]);
+            }
+        });
+        solve_columns(axis, dst);
+    }
+    state_.swap(tmp_state_);
+}
+
+void AdiSolver::solve_columns(int axis, double *out) const
+{
+    const std::size_t nx = n_[0], ny = n_[1], nz = n_[2];
+    const Tridiagonal &tdma = tdma_[axis];
+
+    if (axis == 1 && nz == 1)
+    {
+        // A single plane: blocks of columns per thread, whole cache lines each
+        const std::size_t columns = nx-2, blocks = (columns + kColumnBlock - 1) / kColumnBlock;
+        parallel(blocks, [&](std::size_t begin, std::size_t end)
+        {
+            const std::size_t first = begin * kColumnBlock, last = std::min(end * kColumnBlock, columns);
+            if (first < last)
+                tdma.solve_columns(out + 1 + first, last - first, nx);
+        });
+    }
+    else if (axis == 1)
+    {
+        // One batch of nx-2 columns per z plane
+        parallel(nz-2, [&](std::size_t begin, std::size_t end)
+        {
+            for (std::size_t k = begin+1; k < end+1; ++k)
+            {
+                double *plane = out + nx*ny*k + 1;
+                tdma.solve_columns(plane, nx-2, nx);
+            }
+        });
+    }
+    else
+    {
+        // One batch of nx-2 columns per interior y row
+        parallel(ny-2, [&](std::size_t begin, std::size_t end)
+        {
+            for (std::size_t j = begin+1; j < end+1; ++j)
+            {
+                double *line = out + nx*j + 1;
+                tdma.solve_columns(line, nx-2, nx*ny);
+            }
+        });
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef ADISOLVER_H
+#define ADISOLVER_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "aligned.h"
+#include "heat.h"
+#include "parameters.h"
+#include "threadpool.h"
+#include "tridiagonal.h"
+
+// Alternating direction implicit stepping on a 2-D or 3-D box with fixed
+// faces, second order in time and unconditionally stable. Every step is a set
+// of 1-D Crank-Nicolson type tridiagonal solves, one axis at a time:
+//  - 2-D, Peaceman-Rachford:
+//        (1 - Ax/2) u* = (1 + Ay/2) u,   (1 - Ay/2) u' = (1 + Ax/2) u*,
+//  - 3-D, Douglas:
+//        (1 - Ax/2) u1 = (1 + Ax/2 + Ay + Az) u,
+//        (1 - Ay/2) u2 = u1 - Ay/2 u,   (1 - Az/2) u' = u2 - Az/2 u,
+// with A_a = alpha_a * (discrete second difference along a). Sweeps along x
+// run the prefactorized Thomas solve row by row over contiguous memory,
+// sweeps along y and z solve whole rows of columns side by side, so their
+// inner loops are contiguous too. The axes are described as for GridSolver.
+class AdiSolver
+{
+public:
+    explicit AdiSolver(const std::vector<Parameters> &axes);
+
+    void init(InitialProfile profile);
+    void step();
+    void advance(std::int64_t steps);
+
+    // Splits rows (x sweeps), planes (y and z sweeps) or, on a 2-D grid, blocks
+    // of columns (y sweep) over a persistent pool
+    void set_threads(int threads);
+    int get_threads() const;
+
+    const std::vector<Parameters> &get_axes() const;
+    const AlignedVector &get_state() const;
+    double get_t() const;
+
+    std::size_t index(std::size_t i, std::size_t j, std::size_t k = 0) const;
+
+private:
+    std::vector<Parameters> axes_;
+    std::array<std::size_t, 3> n_;
+    std::array<double, 3> alpha_;
+    std::array<Tridiagonal, 3> tdma_;
+    AlignedVector state_, tmp_state_, tmp2_state_;
+    double t_cur_;
+    std::unique_ptr<ThreadPool> pool_;
+
+    // Calls job(first, last) on ranges of [0, count)
+    template <typename Job>
+    void parallel(std::size_t count, Job job) const;
+    void step_peaceman_rachford();
+    void step_douglas();
+    // Solves along y (axis 1) or z (axis 2) for all interior columns of out
+    void solve_columns(int axis, double *out) const;
+};
+
+#endif // ADISOLVER_H
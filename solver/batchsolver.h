@@ -0,0 +1,50 @@
+#ifndef BATCHSOLVER_H
+#define BATCHSOLVER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "aligned.h"
+#include "heat.h"
+#include "parameters.h"
+
+// Problems are padded to a multiple of kBatchLanes (one AVX-512 register)
+constexpr std::size_t kBatchLanes = 8;
+
+// Advances many independent problems on the same spatial grid at once. The
+// state is stored interleaved (structure of arrays, problem index fastest):
+// node i of problem m lives at [i*stride + m]. Both the explicit stencil and the
+// Thomas sweeps then run their innermost loop across problems, so even the
+// serial TDMA recurrence vectorizes. Every problem keeps its own Parameters
+// (and hence alpha and dt) and its own initial profile; the results of each
+// problem are bit-identical to a Solver run with the same Parameters.
+class BatchSolver
+{
+public:
+    BatchSolver(const std::vector<Parameters> &params, MethodType method);
+
+    void init(const std::vector<InitialProfile> &profiles);
+    void step();
+    void advance(std::int64_t steps);
+
+    std::size_t size() const;
+    std::size_t get_nx() const;
+    const Parameters &get_parameters(std::size_t problem) const;
+    MethodType get_method() const;
+    std::vector<double> get_state(std::size_t problem) const;
+    double get_t(std::size_t problem) const;
+
+private:
+    std::vector<Parameters> params_;
+    MethodType method_;
+    std::size_t nx_, m_, stride_;
+    AlignedVector state_, tmp_state_;
+    AlignedVector alpha_, off_, inv_denominator_;
+    std::vector<double> t_cur_;
+
+    void step_explicit();
+    void step_implicit();
+};
+
+#endif // BATCHSOLVER_H
@@ -0,0 +1,293 @@
+#include "checkpoint.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const char kCheckpointMagic[8] = "HEATCKP";
+constexpr std::uint32_t kCheckpointVersion = 3;
+
+struct CheckpointHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::int32_t method, boundary, conductivity, nonlinear_mode;
+    std::int64_t nx, nt, step;
+    double range_x, range_t, robin, t, initial_peak;
+    std::uint64_t conductivity_checksum, checksum;
+    std::uint64_t header_checksum;  // of everything above, checked before nx is trusted
+};
+
+// FNV-1a over 64-bit words
+static std::uint64_t checksum(const void *data, std::size_t words)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    std::uint64_t hash = 14695981039346656037ull;
+    for (std::size_t w = 0; w < words; ++w)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, bytes + w*sizeof(word), sizeof(word));
+        hash = (hash ^ word) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// Of the state, or of a conductivity field
+static std::uint64_t checksum(const std::vector<double> &state)
+{
+    return checksum(state.data(), state.size());
+}
+
+static std::uint64_t checksum(const CheckpointHeader &header)
+{
+    static_assert(offsetof(CheckpointHeader, header_checksum) % sizeof(std::uint64_t) == 0,
+                  "the header checksum covers whole words");
+    return checksum(&header, offsetof(CheckpointHeader, header_checksum) / sizeof(std::uint64_t));
+}
+
+// Makes a rename in the directory of path durable
+static bool sync_directory(const std::string &path)
+{
+#if defined(_WIN32)
+    // MOVEFILE_WRITE_THROUGH already flushed the rename
+    (void)path;
+    return true;
+#else
+    const std::string::size_type slash = path.find_last_of('/');
+    const std::string dir = (slash == std::string::npos) ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    const int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0)
+        return false;
+    const bool ok = ::fsync(fd) == 0;
+    return (::close(fd) == 0) && ok;
+#endif
+}
+
+// Fills checkpoint in place, reusing the storage of its state
+static void fill(Checkpoint &checkpoint, const Solver &solver)
+{
+    const Parameters &param = solver.get_parameters();
+    checkpoint.nx = param.get_nx();
+    checkpoint.nt = param.get_nt();
+    checkpoint.range_x = param.get_range_x();
+    checkpoint.range_t = param.get_range_t();
+    checkpoint.method = solver.get_method();
+    checkpoint.boundary = solver.get_boundary();
+    checkpoint.robin = solver.get_robin();
+    checkpoint.conductivity = solver.get_conductivity_type();
+    checkpoint.nonlinear_mode = (checkpoint.conductivity == ConductivityType::Function)
+            ? solver.get_nonlinear_mode() : NonlinearMode::Lagged;
+    checkpoint.conductivity_checksum = (checkpoint.conductivity == ConductivityType::Field)
+            ? checksum(solver.get_conductivity()) : 0;
+    checkpoint.step = solver.get_step();
+    checkpoint.t = solver.get_t();
+    checkpoint.initial_peak = solver.get_initial_peak();
+    checkpoint.state.assign(solver.get_state().begin(), solver.get_state().end());
+}
+
+Checkpoint capture(const Solver &solver)
+{
+    Checkpoint checkpoint;
+    fill(checkpoint, solver);
+    return checkpoint;
+}
+
+void restore(Solver &solver, const Checkpoint &checkpoint)
+{
+    const Parameters &param = solver.get_parameters();
+    if (checkpoint.nx != param.get_nx() || checkpoint.nt != param.get_nt()
+            || checkpoint.range_x != param.get_range_x() || checkpoint.range_t != param.get_range_t())
+        throw std::invalid_argument("checkpoint was taken on a different grid");
+    if (checkpoint.method != solver.get_method())
+        throw std::invalid_argument("checkpoint was taken with a different method");
+    if (checkpoint.boundary != solver.get_boundary() || checkpoint.robin != solver.get_robin())
+        throw std::invalid_argument("checkpoint was taken with different boundary conditions");
+
+    const ConductivityType conductivity = solver.get_conductivity_type();
+    if (checkpoint.conductivity != conductivity
+            || (conductivity == ConductivityType::Function && checkpoint.nonlinear_mode != solver.get_nonlinear_mode())
+            || (conductivity == ConductivityType::Field && checkpoint.conductivity_checksum != checksum(solver.get_conductivity())))
+        throw std::invalid_argument("checkpoint was taken with a different conductivity");
+
+    solver.resume(checkpoint.state.data(), checkpoint.t, checkpoint.step, checkpoint.initial_peak);
+}
+
+void save_checkpoint(const std::string &path, const Checkpoint &checkpoint)
+{
+    CheckpointHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kCheckpointMagic, sizeof(header.magic));
+    header.version = kCheckpointVersion;
+    header.method = static_cast<std::int32_t>(checkpoint.method);
+    header.boundary = static_cast<std::int32_t>(checkpoint.boundary);
+    header.conductivity = static_cast<std::int32_t>(checkpoint.conductivity);
+    header.nonlinear_mode = static_cast<std::int32_t>(checkpoint.nonlinear_mode);
+    header.nx = checkpoint.nx;
+    header.nt = checkpoint.nt;
+    header.step = checkpoint.step;
+    header.range_x = checkpoint.range_x;
+    header.range_t = checkpoint.range_t;
+    header.robin = checkpoint.robin;
+    header.t = checkpoint.t;
+    header.initial_peak = checkpoint.initial_peak;
+    header.conductivity_checksum = checkpoint.conductivity_checksum;
+    header.checksum = checksum(checkpoint.state);
+    header.header_checksum = checksum(header);
+
+    const std::string tmp = path + ".tmp";
+    std::FILE *file = std::fopen(tmp.c_str(), "wb");
+    if (!file)
+        throw std::runtime_error("cannot open '" + tmp + "': " + std::strerror(errno));
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1
+            && std::fwrite(checkpoint.state.data(), sizeof(double), checkpoint.state.size(), file) == checkpoint.state.size()
+            && std::fflush(file) == 0;
+#if defined(_WIN32)
+    ok = ok && _commit(_fileno(file)) == 0;
+#else
+    ok = ok && ::fsync(fileno(file)) == 0;
+#endif
+    ok = (std::fclose(file) == 0) && ok;
+
+#if defined(_WIN32)
+    ok = ok && MoveFileExA(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    ok = ok && std::rename(tmp.c_str(), path.c_str()) == 0;
+#endif
+    ok = ok && sync_directory(path);
+    if (!ok)
+    {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("cannot write checkpoint '" + path + "'");
+    }
+}
+
+Checkpoint load_checkpoint(const std::string &path)
+{
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file)
+        throw std::runtime_error("cannot open '" + path + "': " + std::strerror(errno));
+
+    CheckpointHeader header;
+    Checkpoint checkpoint;
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1
+            && std::memcmp(header.magic, kCheckpointMagic, sizeof(header.magic)) == 0
+            && header.version == kCheckpointVersion && checksum(header) == header.header_checksum && header.nx > 0;
+    if (ok)
+    {
+        checkpoint.state.resize(static_cast<std::size_t>(header.nx));
+        ok = std::fread(checkpoint.state.data(), sizeof(double), checkpoint.state.size(), file) == checkpoint.state.size()
+                && checksum(checkpoint.state) == header.checksum;
+    }
+    std::fclose(file);
+    if (!ok)
+        throw std::runtime_error("'" + path + "' is not a valid checkpoint");
+
+    checkpoint.nx = header.nx;
+    checkpoint.nt = header.nt;
+    checkpoint.range_x = header.range_x;
+    checkpoint.range_t = header.range_t;
+    checkpoint.method = static_cast<MethodType>(header.method);
+    checkpoint.boundary = static_cast<BoundaryType>(header.boundary);
+    checkpoint.robin = header.robin;
+    checkpoint.conductivity = static_cast<ConductivityType>(header.conductivity);
+    checkpoint.nonlinear_mode = static_cast<NonlinearMode>(header.nonlinear_mode);
+    checkpoint.conductivity_checksum = header.conductivity_checksum;
+    checkpoint.step = header.step;
+    checkpoint.t = header.t;
+    checkpoint.initial_peak = header.initial_peak;
+    return checkpoint;
+}
+
+Checkpointer::Checkpointer(const std::string &path, std::int64_t every)
+    : path_(path), every_(every), pending_(false), busy_(false), done_(false)
+{
+    if (every_ < 1)
+        throw std::invalid_argument("checkpoint interval must be at least one step");
+
+    thread_ = std::thread(&Checkpointer::run, this);
+}
+
+Checkpointer::~Checkpointer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_ = true;
+    }
+    cond_.notify_all();
+    thread_.join();
+}
+
+void Checkpointer::update(const Solver &solver)
+{
+    if (solver.get_step() % every_ != 0)
+        return;
+    check_error();
+
+    // Fill the queued checkpoint in place to reuse its storage
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fill(queued_, solver);
+        pending_ = true;
+    }
+    cond_.notify_all();
+}
+
+void Checkpointer::flush()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this] { return !pending_ && !busy_; });
+    }
+    check_error();
+}
+
+void Checkpointer::run()
+{
+    Checkpoint writing;
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;)
+    {
+        cond_.wait(lock, [this] { return pending_ || done_; });
+        if (!pending_)
+            break;
+
+        std::swap(writing, queued_);
+        pending_ = false;
+        busy_ = true;
+        lock.unlock();
+
+        std::string error;
+        try
+        {
+            save_checkpoint(path_, writing);
+        }
+        catch (const std::exception &e)
+        {
+            error = e.what();
+        }
+
+        lock.lock();
+        if (!error.empty() && error_.empty())
+            error_ = error;
+        busy_ = false;
+        cond_.notify_all();
+    }
+}
+
+void Checkpointer::check_error()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!error_.empty())
+        throw std::runtime_error(error_);
+}
@@ -0,0 +1,78 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "heat.h"
+#include "solver.h"
+
+// Everything a Solver needs to continue a run bit for bit. The factorized
+// matrices are not stored: they are rebuilt deterministically from the
+// parameters when the solver is constructed.
+struct Checkpoint
+{
+    std::int64_t nx, nt;
+    double range_x, range_t;
+    MethodType method;
+    BoundaryType boundary;
+    double robin;
+    // Conductivity setup; the field enters through its checksum, the mode
+    // only matters for a function
+    ConductivityType conductivity;
+    NonlinearMode nonlinear_mode;
+    std::uint64_t conductivity_checksum;
+    std::int64_t step;
+    double t;
+    double initial_peak;    // divergence baseline of the run
+    std::vector<double> state;
+};
+
+Checkpoint capture(const Solver &solver);
+// Throws std::invalid_argument when the solver is set up differently
+void restore(Solver &solver, const Checkpoint &checkpoint);
+
+// Written to path.tmp, synced and renamed over path, then the directory is
+// synced, so a crash or power loss leaves either checkpoint intact. Header and
+// state carry separate checksums; the header one is checked before its sizes
+// are used.
+void save_checkpoint(const std::string &path, const Checkpoint &checkpoint);
+Checkpoint load_checkpoint(const std::string &path);
+
+// Saves a checkpoint every `every` steps from a background thread. update()
+// only copies the state; if the previous save is still running the newer
+// checkpoint replaces the queued one. Errors are reported by the next
+// update() or flush().
+class Checkpointer
+{
+public:
+    Checkpointer(const std::string &path, std::int64_t every);
+    ~Checkpointer();
+
+    Checkpointer(const Checkpointer &) = delete;
+    Checkpointer &operator=(const Checkpointer &) = delete;
+
+    void update(const Solver &solver);
+    // Waits until the latest checkpoint is on disk
+    void flush();
+
+private:
+    std::string path_;
+    std::int64_t every_;
+    Checkpoint queued_;
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool pending_, busy_, done_;
+    std::string error_;
+
+    void run();
+    void check_error();
+};
+
+#endif // CHECKPOINT_H
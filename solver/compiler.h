@@ -0,0 +1,31 @@
+#ifndef COMPILER_H
+#define COMPILER_H
+
+// Function attributes shared by the numeric kernels
+
+// AVX-512 and -march=haswell imply FMA: keep GCC from contracting mul+add,
+// which would change the rounding with respect to the scalar kernels. Every
+// path that promises results bit-identical to another one carries it.
+#if defined(__GNUC__) && !defined(__clang__)
+#define HEAT_NO_CONTRACT __attribute__((optimize("fp-contract=off")))
+#else
+#define HEAT_NO_CONTRACT
+#endif
+
+// The selects of the exp() kernel are only if-converted, and so vectorized,
+// when comparisons are not assumed to raise floating-point exceptions
+#if defined(__GNUC__) && !defined(__clang__)
+#define HEAT_NO_TRAPPING __attribute__((optimize("no-trapping-math")))
+#else
+#define HEAT_NO_TRAPPING
+#endif
+
+// Forces the shared helpers into every target-specific caller, which then
+// compiles them for its own instruction set
+#if defined(__GNUC__) || defined(__clang__)
+#define HEAT_INLINE inline __attribute__((always_inline))
+#else
+#define HEAT_INLINE inline
+#endif
+
+#endif // COMPILER_H
@@ -0,0 +1,67 @@
+#include "exactcache.h"
+
+ExactCache::ExactCache(std::size_t capacity)
+    : capacity_(capacity > 0 ? capacity : 1), clock_(0), hits_(0), misses_(0)
+{}
+
+ExactCache::Profile ExactCache::get(std::int64_t n, double t, InitialProfile profile, double ampl)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++clock_;
+
+    for (Entry &entry: entries_)
+    {
+        if (entry.profile == profile && entry.n == n && entry.t == t && entry.ampl == ampl)
+        {
+            entry.used = clock_;
+            ++hits_;
+            return entry.values;
+        }
+    }
+    ++misses_;
+
+    Entry *slot;
+    if (entries_.size() < capacity_)
+    {
+        entries_.push_back(Entry());
+        slot = &entries_.back();
+    }
+    else
+    {
+        slot = &entries_.front();
+        for (Entry &entry: entries_)
+            if (entry.used < slot->used)
+                slot = &entry;
+    }
+
+    // Recycle the evicted buffer unless a caller still reads it
+    if (!slot->values || slot->values.use_count() > 1)
+        slot->values = std::make_shared<std::vector<double>>();
+    slot->values->resize(static_cast<std::size_t>(n));
+    exact(n, t, profile, ampl, slot->values->data());
+
+    slot->profile = profile;
+    slot->n = n;
+    slot->t = t;
+    slot->ampl = ampl;
+    slot->used = clock_;
+    return slot->values;
+}
+
+void ExactCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+}
+
+std::int64_t ExactCache::get_hits() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+}
+
+std::int64_t ExactCache::get_misses() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+}
@@ -0,0 +1,45 @@
+#ifndef EXACTCACHE_H
+#define EXACTCACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "heat.h"
+
+// Memoizes exact() profiles keyed by (profile, n, t, ampl), so comparing
+// several methods against the same reference evaluates it once. The least
+// recently used entry is evicted beyond capacity, and its buffer is reused
+// when no caller still holds it. Safe to share between threads.
+class ExactCache
+{
+public:
+    typedef std::shared_ptr<const std::vector<double>> Profile;
+
+    explicit ExactCache(std::size_t capacity = 8);
+
+    Profile get(std::int64_t n, double t, InitialProfile profile, double ampl);
+    void clear();
+
+    std::int64_t get_hits() const;
+    std::int64_t get_misses() const;
+
+private:
+    struct Entry
+    {
+        InitialProfile profile;
+        std::int64_t n;
+        double t, ampl;
+        std::uint64_t used;
+        std::shared_ptr<std::vector<double>> values;
+    };
+
+    std::size_t capacity_;
+    std::vector<Entry> entries_;
+    std::uint64_t clock_;
+    std::int64_t hits_, misses_;
+    mutable std::mutex mutex_;
+};
+
+#endif // EXACTCACHE_H
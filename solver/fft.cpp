@@ -0,0 +1,143 @@
+#include "fft.h"
+
+#include <algorithm>
+#include <cmath>
+
+static bool is_pow2(std::size_t n)
+{
+    return n && !(n & (n-1));
+}
+
+FFT::FFT(std::size_t n)
+    : n_(n)
+{
+    if (n_ <= 1)
+        return;
+
+    if (is_pow2(n_))
+    {
+        int bits = 0;
+        while ((std::size_t(1) << bits) < n_)
+            ++bits;
+        reversed_.resize(n_);
+        for (std::size_t i = 0; i < n_; ++i)
+        {
+            std::size_t r = 0;
+            for (int b = 0; b < bits; ++b)
+                r |= ((i >> b) & 1) << (bits-1-b);
+            reversed_[i] = r;
+        }
+
+        twiddles_.resize(n_/2);
+        for (std::size_t k = 0; k < n_/2; ++k)
+            twiddles_[k] = std::polar(1.0, -2.0*M_PI*k/n_);
+        return;
+    }
+
+    std::size_t m = 1;
+    while (m < 2*n_-1)
+        m <<= 1;
+    pow2_.reset(new FFT(m));
+
+    // j^2 mod 2n keeps the chirp argument small and accurate for large n
+    chirp_.resize(n_);
+    for (std::size_t j = 0; j < n_; ++j)
+        chirp_[j] = std::polar(1.0, -M_PI * double((j*j) % (2*n_)) / n_);
+
+    kernel_.assign(m, 0.0);
+    kernel_[0] = std::conj(chirp_[0]);
+    for (std::size_t j = 1; j < n_; ++j)
+        kernel_[j] = kernel_[m-j] = std::conj(chirp_[j]);
+    pow2_->forward(kernel_.data());
+
+    work_.resize(m);
+}
+
+std::size_t FFT::size() const
+{
+    return n_;
+}
+
+void FFT::forward(std::complex<double> *data) const
+{
+    if (n_ <= 1)
+        return;
+    if (pow2_)
+        bluestein(data);
+    else
+        radix2(data);
+}
+
+void FFT::inverse(std::complex<double> *data) const
+{
+    // conj(F(conj(x))) is the unnormalized inverse transform
+    for (std::size_t i = 0; i < n_; ++i)
+        data[i] = std::conj(data[i]);
+    forward(data);
+    for (std::size_t i = 0; i < n_; ++i)
+        data[i] = std::conj(data[i]);
+}
+
+void FFT::radix2(std::complex<double> *data) const
+{
+    for (std::size_t i = 0; i < n_; ++i)
+        if (i < reversed_[i])
+            std::swap(data[i], data[reversed_[i]]);
+
+    for (std::size_t len = 2; len <= n_; len <<= 1)
+    {
+        std::size_t half = len/2, stride = n_/len;
+        for (std::size_t start = 0; start < n_; start += len)
+        {
+            for (std::size_t k = 0; k < half; ++k)
+            {
+                std::complex<double> a = data[start+k];
+                std::complex<double> b = data[start+k+half] * twiddles_[k*stride];
+                data[start+k] = a + b;
+                data[start+k+half] = a - b;
+            }
+        }
+    }
+}
+
+void FFT::bluestein(std::complex<double> *data) const
+{
+    const std::size_t m = work_.size();
+    for (std::size_t j = 0; j < n_; ++j)
+        work_[j] = data[j] * chirp_[j];
+    std::fill(work_.begin() + n_, work_.end(), 0.0);
+
+    pow2_->forward(work_.data());
+    for (std::size_t k = 0; k < m; ++k)
+        work_[k] *= kernel_[k];
+    pow2_->inverse(work_.data());
+
+    for (std::size_t k = 0; k < n_; ++k)
+        data[k] = work_[k] * chirp_[k] / double(m);
+}
+
+SineTransform::SineTransform(std::size_t n)
+    : n_(n), fft_(2*(n+1)), buffer_(2*(n+1))
+{}
+
+std::size_t SineTransform::size() const
+{
+    return n_;
+}
+
+void SineTransform::transform(const double *in, double *out) const
+{
+    // Odd extension [0, x, 0, -reversed x] has the transform -2i X
+    const std::size_t m = buffer_.size();
+    buffer_[0] = buffer_[n_+1] = 0.0;
+    for (std::size_t j = 0; j < n_; ++j)
+    {
+        buffer_[j+1] = in[j];
+        buffer_[m-1-j] = -in[j];
+    }
+
+    fft_.forward(buffer_.data());
+
+    for (std::size_t k = 0; k < n_; ++k)
+        out[k] = -0.5 * buffer_[k+1].imag();
+}
@@ -0,0 +1,63 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Complex discrete Fourier transform of any length n in O(n log n):
+//     X[k] = sum_j x[j] exp(-2 pi i jk/n)   (forward, unnormalized).
+// Powers of two use an iterative radix-2 transform with precomputed twiddles
+// and bit reversal table; other lengths go through Bluestein's chirp-z
+// algorithm on top of a power-of-two transform. Building one is the expensive
+// part, so keep an instance per size. The transforms are const but the
+// Bluestein path writes a scratch buffer of the instance: one FFT must not be
+// used from several threads at once.
+class FFT
+{
+public:
+    explicit FFT(std::size_t n);
+
+    std::size_t size() const;
+    void forward(std::complex<double> *data) const;
+    // Unnormalized as well, inverse(forward(x)) = n*x
+    void inverse(std::complex<double> *data) const;
+
+private:
+    std::size_t n_;
+    std::vector<std::size_t> reversed_;
+    std::vector<std::complex<double>> twiddles_;
+
+    // Bluestein: chirp w[j] = exp(-pi i j^2/n) and the transformed
+    // convolution kernel on the power-of-two grid of size m >= 2n-1
+    std::unique_ptr<FFT> pow2_;
+    std::vector<std::complex<double>> chirp_, kernel_;
+    mutable std::vector<std::complex<double>> work_;
+
+    void radix2(std::complex<double> *data) const;
+    void bluestein(std::complex<double> *data) const;
+};
+
+// Type-I discrete sine transform of n values:
+//     X[k] = sum_{j=0}^{n-1} x[j] sin(pi (j+1)(k+1)/(n+1)).
+// The sines are the eigenvectors of the discrete Laplacian with zero Dirichlet
+// ends, which makes this the spectral basis of the solver grids. The transform
+// is its own inverse up to the factor 2/(n+1). Like FFT, transform() writes
+// scratch buffers of the instance and is not safe to call concurrently on a
+// shared one.
+class SineTransform
+{
+public:
+    explicit SineTransform(std::size_t n);
+
+    std::size_t size() const;
+    void transform(const double *in, double *out) const;
+
+private:
+    std::size_t n_;
+    FFT fft_;
+    mutable std::vector<std::complex<double>> buffer_;
+};
+
+#endif // FFT_H
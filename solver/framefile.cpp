@@ -0,0 +1,266 @@
+#include "framefile.h"
+
+#include <cerrno>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char kFrameMagic[8] = "HEATFRM";
+
+FrameWriter::FrameWriter(const std::string &path, const Parameters &param, InitialProfile profile, MethodType method,
+                         std::int64_t every, FramePrecision precision, std::size_t chunk_frames)
+    : file_(nullptr), chunk_frames_(chunk_frames > 0 ? chunk_frames : 1), fill_frames_(0), flush_bytes_(0),
+      pending_(false), done_(false)
+{
+    if (every < 1)
+        throw std::invalid_argument("frame interval must be at least one step");
+
+    std::memset(&header_, 0, sizeof(header_));
+    std::memcpy(header_.magic, kFrameMagic, sizeof(header_.magic));
+    header_.version = kFrameVersion;
+    header_.value_size = (precision == FramePrecision::Float32) ? sizeof(float) : sizeof(double);
+    header_.nx = param.get_nx();
+    header_.nt = param.get_nt();
+    header_.every = every;
+    header_.frames = 0;
+    header_.range_x = param.get_range_x();
+    header_.range_t = param.get_range_t();
+    header_.dx = param.get_dx();
+    header_.dt = param.get_dt();
+    header_.profile = static_cast<std::int32_t>(profile);
+    header_.method = static_cast<std::int32_t>(method);
+
+    frame_bytes_ = static_cast<std::size_t>(header_.nx) * header_.value_size;
+    fill_.resize(frame_bytes_ * chunk_frames_);
+    flush_.resize(fill_.size());
+
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_)
+        throw std::runtime_error("cannot open '" + path + "': " + std::strerror(errno));
+
+    // Placeholder header page, rewritten with the frame count by close()
+    std::vector<char> page(kFrameHeaderSize, 0);
+    std::memcpy(page.data(), &header_, sizeof(header_));
+    if (std::fwrite(page.data(), 1, page.size(), file_) != page.size())
+    {
+        std::fclose(file_);
+        file_ = nullptr;
+        throw std::runtime_error("cannot write '" + path + "'");
+    }
+
+    thread_ = std::thread(&FrameWriter::run, this);
+}
+
+FrameWriter::~FrameWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+    }
+}
+
+void FrameWriter::write(std::int64_t step, const double *state)
+{
+    if (step % header_.every != 0)
+        return;
+    check_error();
+
+    char *frame = fill_.data() + fill_frames_ * frame_bytes_;
+    if (header_.value_size == sizeof(double))
+    {
+        std::memcpy(frame, state, frame_bytes_);
+    }
+    else
+    {
+        float *out = reinterpret_cast<float *>(frame);
+        for (std::int64_t i = 0; i < header_.nx; ++i)
+            out[i] = static_cast<float>(state[i]);
+    }
+    ++header_.frames;
+
+    if (++fill_frames_ == chunk_frames_)
+        hand_off();
+}
+
+void FrameWriter::close()
+{
+    if (!file_)
+        return;
+
+    if (fill_frames_ > 0)
+        hand_off();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_ = true;
+    }
+    cond_.notify_all();
+    thread_.join();
+
+    std::vector<char> page(kFrameHeaderSize, 0);
+    std::memcpy(page.data(), &header_, sizeof(header_));
+    if (std::fseek(file_, 0, SEEK_SET) != 0 || std::fwrite(page.data(), 1, page.size(), file_) != page.size())
+        error_ = "cannot finalize frame header";
+    if (std::fclose(file_) != 0 && error_.empty())
+        error_ = "cannot close frame file";
+    file_ = nullptr;
+
+    check_error();
+}
+
+std::int64_t FrameWriter::get_every() const
+{
+    return header_.every;
+}
+
+std::int64_t FrameWriter::get_frames() const
+{
+    return header_.frames;
+}
+
+void FrameWriter::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;)
+    {
+        cond_.wait(lock, [this] { return pending_ || done_; });
+        if (!pending_)
+            break;
+
+        // flush_ belongs to this thread until pending_ is cleared
+        lock.unlock();
+        const bool ok = std::fwrite(flush_.data(), 1, flush_bytes_, file_) == flush_bytes_;
+        lock.lock();
+
+        if (!ok && error_.empty())
+            error_ = std::string("frame write failed: ") + std::strerror(errno);
+        pending_ = false;
+        cond_.notify_all();
+    }
+}
+
+void FrameWriter::hand_off()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this] { return !pending_; });
+        fill_.swap(flush_);
+        flush_bytes_ = fill_frames_ * frame_bytes_;
+        pending_ = true;
+    }
+    cond_.notify_all();
+    fill_frames_ = 0;
+}
+
+void FrameWriter::check_error()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!error_.empty())
+        throw std::runtime_error(error_);
+}
+
+FrameReader::FrameReader(const std::string &path)
+    : data_(nullptr), size_(0)
+{
+#if defined(_WIN32)
+    file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("cannot open '" + path + "'");
+    LARGE_INTEGER size;
+    GetFileSizeEx(file_, &size);
+    size_ = static_cast<std::size_t>(size.QuadPart);
+    mapping_ = (size_ > 0) ? CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    if (mapping_)
+        data_ = static_cast<const char *>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+#else
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0)
+        throw std::runtime_error("cannot open '" + path + "': " + std::strerror(errno));
+    struct stat st;
+    if (::fstat(fd_, &st) == 0)
+        size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ > 0)
+    {
+        void *map = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+        if (map != MAP_FAILED)
+            data_ = static_cast<const char *>(map);
+    }
+#endif
+
+    std::string error;
+    if (!data_ || size_ < kFrameHeaderSize)
+        error = "'" + path + "' is not a frame file";
+    else
+    {
+        std::memcpy(&header_, data_, sizeof(header_));
+        if (std::memcmp(header_.magic, kFrameMagic, sizeof(header_.magic)) != 0 || header_.version != kFrameVersion
+                || (header_.value_size != sizeof(double) && header_.value_size != sizeof(float)) || header_.nx < 1)
+            error = "'" + path + "' is not a frame file";
+    }
+    if (!error.empty())
+    {
+        unmap();
+        throw std::runtime_error(error);
+    }
+
+    // A run that never reached close() leaves frames = 0: trust the file size
+    const std::int64_t stored = static_cast<std::int64_t>((size_ - kFrameHeaderSize) / (header_.nx * header_.value_size));
+    if (header_.frames == 0 || header_.frames > stored)
+        header_.frames = stored;
+}
+
+FrameReader::~FrameReader()
+{
+    unmap();
+}
+
+void FrameReader::unmap()
+{
+#if defined(_WIN32)
+    if (data_)
+        UnmapViewOfFile(data_);
+    if (mapping_)
+        CloseHandle(mapping_);
+    CloseHandle(file_);
+#else
+    if (data_)
+        ::munmap(const_cast<char *>(data_), size_);
+    ::close(fd_);
+#endif
+    data_ = nullptr;
+}
+
+const FrameHeader &FrameReader::get_header() const
+{
+    return header_;
+}
+
+std::int64_t FrameReader::get_frames() const
+{
+    return header_.frames;
+}
+
+double FrameReader::get_t(std::int64_t frame) const
+{
+    return frame * header_.every * header_.dt;
+}
+
+std::vector<double> FrameReader::read(std::int64_t k) const
+{
+    if (header_.value_size == sizeof(double))
+    {
+        const double *values = frame<double>(k);
+        return std::vector<double>(values, values + header_.nx);
+    }
+    const float *values = frame<float>(k);
+    return std::vector<double>(values, values + header_.nx);
+}
@@ -0,0 +1,113 @@
+#ifndef FRAMEFILE_H
+#define FRAMEFILE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "heat.h"
+#include "parameters.h"
+
+enum class FramePrecision {Float64, Float32};
+
+// Space-time solution on disk: a fixed-size header page followed by
+// contiguous frames of nx values, frame k holding the state after k*every
+// steps (frame 0 is the initial state). The header is padded to a full page
+// so every frame of a mapped file is naturally aligned.
+constexpr std::size_t kFrameHeaderSize = 4096;
+constexpr std::uint32_t kFrameVersion = 1;
+
+struct FrameHeader
+{
+    char magic[8];            // "HEATFRM" and a terminating zero
+    std::uint32_t version;
+    std::uint32_t value_size; // 8 for float64 frames, 4 for float32
+    std::int64_t nx, nt, every, frames;
+    double range_x, range_t, dx, dt;
+    std::int32_t profile, method;
+};
+
+// Streams frames through a background I/O thread. Frames are packed into
+// chunks of chunk_frames; while one chunk is being written the other fills,
+// so write() only waits when the disk falls a whole chunk behind the solver.
+// I/O errors are reported by the next write() or close().
+class FrameWriter
+{
+public:
+    FrameWriter(const std::string &path, const Parameters &param, InitialProfile profile, MethodType method,
+                std::int64_t every, FramePrecision precision = FramePrecision::Float64, std::size_t chunk_frames = 64);
+    ~FrameWriter();
+
+    FrameWriter(const FrameWriter &) = delete;
+    FrameWriter &operator=(const FrameWriter &) = delete;
+
+    // Records state when step is a multiple of every, ignores it otherwise
+    void write(std::int64_t step, const double *state);
+    // Flushes the pending chunk and finalizes the header; called by the destructor
+    void close();
+
+    std::int64_t get_every() const;
+    std::int64_t get_frames() const;
+
+private:
+    std::FILE *file_;
+    FrameHeader header_;
+    std::size_t frame_bytes_, chunk_frames_;
+    std::vector<char> fill_, flush_;
+    std::size_t fill_frames_, flush_bytes_;
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool pending_, done_;
+    std::string error_;
+
+    void run();
+    void hand_off();
+    void check_error();
+};
+
+// Read-only memory mapping of a frame file; frames are served in place
+class FrameReader
+{
+public:
+    explicit FrameReader(const std::string &path);
+    ~FrameReader();
+
+    FrameReader(const FrameReader &) = delete;
+    FrameReader &operator=(const FrameReader &) = delete;
+
+    const FrameHeader &get_header() const;
+    std::int64_t get_frames() const;
+    double get_t(std::int64_t frame) const;
+
+    // Pointer into the mapping; T must match the stored precision
+    template <typename T>
+    const T *frame(std::int64_t k) const
+    {
+        if (sizeof(T) != header_.value_size)
+            throw std::logic_error("frame precision mismatch");
+        return reinterpret_cast<const T *>(data_ + kFrameHeaderSize + k * header_.nx * header_.value_size);
+    }
+    // Converting copy of one frame, whatever the stored precision
+    std::vector<double> read(std::int64_t k) const;
+
+private:
+    const char *data_;
+    std::size_t size_;
+    FrameHeader header_;
+#if defined(_WIN32)
+    void *file_, *mapping_;
+#else
+    int fd_;
+#endif
+
+    void unmap();
+};
+
+#endif // FRAMEFILE_H
@@ -0,0 +1,183 @@
+#include "gridsolver.h"
+
+#include <cmath>
+#include <stdexcept>
+
+GridSolver::GridSolver(const std::vector<Parameters> &axes, MethodType method)
+    : axes_(axes), method_(method), tolerance_(1e-10), t_cur_(0.0), cycles_(0)
+{
+    if (axes_.empty() || axes_.size() > 3)
+        throw std::invalid_argument("GridSolver needs one to three axes");
+
+    n_.fill(1);
+    alpha_.fill(0.0);
+    for (std::size_t a = 0; a < axes_.size(); ++a)
+    {
+        if (axes_[a].get_nx() < 3)
+            throw std::invalid_argument("every axis needs at least 3 points");
+        if (std::abs(axes_[a].get_dt() - axes_[0].get_dt()) > 1e-12 * axes_[0].get_dt())
+            throw std::invalid_argument("all axes must share the time step");
+        n_[a] = axes_[a].get_nx();
+        alpha_[a] = axes_[a].get_alpha();
+    }
+
+    state_.resize(n_[0] * n_[1] * n_[2]);
+    tmp_state_.resize(state_.size());
+
+    switch (method_)
+    {
+    case MethodType::Explicit:
+        break;
+    case MethodType::Implicit:
+        multigrid_ = Multigrid(n_, alpha_);
+        break;
+    case MethodType::CrankNicolson:
+        multigrid_ = Multigrid(n_, {0.5*alpha_[0], 0.5*alpha_[1], 0.5*alpha_[2]});
+        break;
+    }
+}
+
+void GridSolver::init(InitialProfile profile)
+{
+    init_grid(axes_, profile, state_);
+    tmp_state_ = state_;
+
+    t_cur_ = 0.0;
+    cycles_ = 0;
+}
+
+void GridSolver::step()
+{
+    switch (method_)
+    {
+    case MethodType::Explicit:
+        apply_explicit(1.0);
+        state_.swap(tmp_state_);
+        break;
+    case MethodType::Implicit:
+        tmp_state_ = state_;
+        cycles_ = multigrid_.solve(state_.data(), tmp_state_.data(), tolerance_, kMaxCycles);
+        state_.swap(tmp_state_);
+        break;
+    case MethodType::CrankNicolson:
+        apply_explicit(0.5);
+        // The explicit half step is a better initial guess than the old state
+        state_ = tmp_state_;
+        cycles_ = multigrid_.solve(tmp_state_.data(), state_.data(), tolerance_, kMaxCycles);
+        break;
+    }
+
+    t_cur_ += axes_[0].get_dt();
+}
+
+void GridSolver::advance(std::int64_t steps)
+{
+    for (std::int64_t k = 0; k < steps; ++k)
+        step();
+}
+
+void GridSolver::set_tolerance(double tolerance)
+{
+    tolerance_ = tolerance;
+}
+
+void GridSolver::set_threads(int threads)
+{
+    pool_.reset(threads > 1 ? new ThreadPool(threads) : nullptr);
+    multigrid_.set_pool(pool_.get());
+}
+
+int GridSolver::get_threads() const
+{
+    return pool_ ? pool_->size() : 1;
+}
+
+const std::vector<Parameters> &GridSolver::get_axes() const
+{
+    return axes_;
+}
+
+MethodType GridSolver::get_method() const
+{
+    return method_;
+}
+
+const AlignedVector &GridSolver::get_state() const
+{
+    return state_;
+}
+
+double GridSolver::get_t() const
+{
+    return t_cur_;
+}
+
+int GridSolver::get_cycles() const
+{
+    return cycles_;
+}
+
+std::size_t GridSolver::index(std::size_t i, std::size_t j, std::size_t k) const
+{
+    return i + n_[0]*(j + n_[1]*k);
+}
+
+void GridSolver::apply_explicit(double weight)
+{
+    const std::size_t nx = n_[0], ny = n_[1], nz = n_[2];
+    const std::size_t sy = (ny > 1) ? nx : 0, sz = (nz > 1) ? nx*ny : 0;
+    const double cx = weight*alpha_[0], cy = weight*alpha_[1], cz = weight*alpha_[2];
+    const double *s = state_.data();
+    double *d = tmp_state_.data();
+
+    // Faces keep their values, tmp_state_ already holds them
+    const std::size_t j0 = (ny > 1) ? 1 : 0, rows_y = (ny > 1) ? ny-2 : 1;
+    const std::size_t k0 = (nz > 1) ? 1 : 0, rows = rows_y * ((nz > 1) ? nz-2 : 1);
+    auto job = [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t r = begin; r < end; ++r)
+        {
+            const std::size_t row = nx*((j0 + r % rows_y) + ny*(k0 + r / rows_y));
+            for (std::size_t i = row+1; i < row+nx-1; ++i)
+                d[i] = s[i] + cx*(s[i-1] - 2.0*s[i] + s[i+1]) + cy*(s[i-sy] - 2.0*s[i] + s[i+sy]) + cz*(s[i-sz] - 2.0*s[i] + s[i+sz]);
+        }
+    };
+
+    if (!pool_)
+    {
+        job(0, rows);
+        return;
+    }
+    const std::size_t threads = pool_->size();
+    pool_->run([&](int index)
+    {
+        job(rows * index / threads, rows * (index+1) / threads);
+    });
+}
+
+void init_grid(const std::vector<Parameters> &axes, InitialProfile profile, AlignedVector &state)
+{
+    // The Delta amplitude keeps the same total heat per unit length along every axis
+    std::size_t n[3] = {1, 1, 1};
+    double ampl = 1.0;
+    for (std::size_t a = 0; a < axes.size(); ++a)
+    {
+        n[a] = axes[a].get_nx();
+        ampl *= amplitude(profile, axes[a].get_dx());
+    }
+
+    state.resize(n[0] * n[1] * n[2]);
+    for (std::size_t k = 0; k < n[2]; ++k)
+        for (std::size_t j = 0; j < n[1]; ++j)
+            for (std::size_t i = 0; i < n[0]; ++i)
+            {
+                const std::size_t pos[3] = {i, j, k};
+                double r2 = 0.0;
+                for (std::size_t a = 0; a < axes.size(); ++a)
+                {
+                    double x = (double(pos[a]) - n[a]/2) * axes[a].get_dx();
+                    r2 += x*x;
+                }
+                state[i + n[0]*(j + n[1]*k)] = initial(std::sqrt(r2), profile, ampl);
+            }
+}
@@ -0,0 +1,66 @@
+#ifndef GRIDSOLVER_H
+#define GRIDSOLVER_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "aligned.h"
+#include "heat.h"
+#include "multigrid.h"
+#include "parameters.h"
+#include "threadpool.h"
+
+// Heat equation on a 1-, 2- or 3-D box with fixed faces, 3/5/7-point
+// stencils. Every axis is described by its own Parameters (points, range and
+// therefore dx and alpha); they must agree on the time step. The Implicit and
+// Crank-Nicolson systems are solved by multigrid V-cycles warm started from
+// the previous state instead of the 1-D Thomas sweep; a step whose solve does
+// not reach the tolerance within kMaxCycles throws std::runtime_error.
+class GridSolver
+{
+public:
+    GridSolver(const std::vector<Parameters> &axes, MethodType method);
+
+    void init(InitialProfile profile);
+    void step();
+    void advance(std::int64_t steps);
+
+    // Relative residual the implicit solves stop at (default 1e-10)
+    void set_tolerance(double tolerance);
+    // Splits the rows of the stencil and multigrid sweeps over a persistent pool
+    void set_threads(int threads);
+    int get_threads() const;
+
+    const std::vector<Parameters> &get_axes() const;
+    MethodType get_method() const;
+    const AlignedVector &get_state() const;
+    double get_t() const;
+    // Multigrid cycles taken by the last implicit step
+    int get_cycles() const;
+
+    std::size_t index(std::size_t i, std::size_t j, std::size_t k = 0) const;
+
+private:
+    static constexpr int kMaxCycles = 50;
+
+    std::vector<Parameters> axes_;
+    MethodType method_;
+    std::array<std::size_t, 3> n_;
+    std::array<double, 3> alpha_;
+    AlignedVector state_, tmp_state_;
+    Multigrid multigrid_;
+    double tolerance_;
+    double t_cur_;
+    int cycles_;
+    std::unique_ptr<ThreadPool> pool_;
+
+    // tmp_state_ = state_ + weight * sum_a alpha_a * (discrete Laplacian along a)
+    void apply_explicit(double weight);
+};
+
+// Radial version of the 1-D profile sampled on the grid of the axes, x fastest
+void init_grid(const std::vector<Parameters> &axes, InitialProfile profile, AlignedVector &state);
+
+#endif // GRIDSOLVER_H
@@ -0,0 +1,183 @@
+#include "heat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+#include "kernels.h"
+#include "profiler.h"
+
+double initial(double x, InitialProfile profile, double ampl)
+{
+    switch (profile)
+    {
+    case InitialProfile::Gauss:
+        return ampl * std::exp(-std::pow(x / (0.1*kRangeX), 2.0));
+    case InitialProfile::SuperGauss:
+        return ampl * std::exp(-std::pow(x / (0.1*kRangeX), 8.0));
+    case InitialProfile::Rectangle:
+        return ampl * ((std::abs(x) < 0.1*kRangeX) ? 1.0 : 0.0);
+    case InitialProfile::Delta:
+        return ampl * ((std::abs(x) < 1e-10*kRangeX) ? 1.0 : 0.0);
+    default:
+        return 0;
+    }
+}
+
+double amplitude(InitialProfile profile, double dx)
+{
+    return (profile == InitialProfile::Delta) ? kRangeX*0.1/dx : 1.0;
+}
+
+std::pair<double, double> dispersion_diffusion(double q_N, double alpha, MethodType type)
+{
+    std::complex<double> lambda;
+    double kappa = 2.0*M_PI*q_N;
+    switch (type)
+    {
+    case MethodType::Explicit:
+        lambda = 1.0 - 2.0 * alpha * (1.0 - std::cos(kappa));
+        break;
+    case MethodType::Implicit:
+        lambda = 1.0 / (1.0 + 2.0 * alpha * (1.0 - std::cos(kappa)));
+        break;
+    case MethodType::CrankNicolson:
+        lambda = (1.0 - alpha * (1.0 - std::cos(kappa))) / (1.0 + alpha * (1.0 - std::cos(kappa)));
+        break;
+    default:
+        lambda = 1.0;
+        break;
+    }
+
+    lambda = std::log(lambda);
+
+    return std::make_pair(std::imag(lambda), -std::real(lambda));
+}
+
+bool is_stable(double alpha, MethodType type)
+{
+    return dispersion_diffusion(0.5, alpha, type).second >= 0.0;
+}
+
+std::vector<double> exact(std::int64_t n, double t, InitialProfile profile, double ampl)
+{
+    std::vector<double> res(n);
+    exact(n, t, profile, ampl, res.data());
+    return res;
+}
+
+void exact(std::int64_t n, double t, InitialProfile profile, double ampl, double *out)
+{
+    HEAT_PROFILE(Phase::Exact, 0, n);
+
+    const double h = kRangeX / n;
+    const double x0 = -double(n/2) * h;
+
+    if (t == 0)
+    {
+        for (std::int64_t i = 0; i < n; ++i)
+            out[i] = initial(x0 + i*h, profile, ampl);
+        return;
+    }
+
+    // Constants of the closed forms are hoisted out of the loops, the
+    // Gaussians go through the vectorized exp() of gaussian()
+    switch (profile)
+    {
+        case InitialProfile::Gauss:
+        {
+            const double r0 = 0.1 * kRangeX;
+            const double width2 = r0*r0 + 4.0*t;
+            gaussian(out, n, x0, h, 1.0 / width2, r0 * std::sqrt(M_PI) / 4.0 / t / std::sqrt(width2));
+            break;
+        }
+        case InitialProfile::SuperGauss:
+        {
+            std::fill(out, out + n, 0.0);
+            break;
+        }
+        case InitialProfile::Rectangle:
+        {
+            const double a = 0.1*kRangeX;
+            const double inv_scale = 0.5 / std::sqrt(t);
+            const double factor = std::sqrt(M_PI) / 8.0 / t;
+            for (std::int64_t i = 0; i < n; ++i)
+            {
+                const double xi = x0 + i*h;
+                out[i] = factor * (std::erf((a - xi) * inv_scale) + std::erf((a + xi) * inv_scale));
+            }
+            break;
+        }
+        case InitialProfile::Delta:
+        {
+            gaussian(out, n, x0, h, 0.25 / t, 1.0 / 8.0 / (t * std::sqrt(t)));
+            break;
+        }
+    }
+}
+
+ErrorNorms error_norms(const double *state, const double *reference, std::int64_t n, double dx)
+{
+    ErrorNorms norms = {0.0, 0.0, 0.0};
+    for (std::int64_t i = 0; i < n; ++i)
+    {
+        double diff = std::abs(state[i] - reference[i]);
+        norms.l1 += diff;
+        norms.l2 += diff*diff;
+        if (diff > norms.linf || std::isnan(diff))
+            norms.linf = diff;
+    }
+    norms.l1 *= dx;
+    norms.l2 = std::sqrt(norms.l2 * dx);
+
+    return norms;
+}
+
+const char *profile_name(InitialProfile profile)
+{
+    switch (profile)
+    {
+    case InitialProfile::Gauss:
+        return "gauss";
+    case InitialProfile::SuperGauss:
+        return "supergauss";
+    case InitialProfile::Rectangle:
+        return "rectangle";
+    case InitialProfile::Delta:
+        return "delta";
+    default:
+        return "";
+    }
+}
+
+const char *method_name(MethodType type)
+{
+    switch (type)
+    {
+    case MethodType::Explicit:
+        return "explicit";
+    case MethodType::Implicit:
+        return "implicit";
+    case MethodType::CrankNicolson:
+        return "cn";
+    default:
+        return "";
+    }
+}
+
+const char *boundary_name(BoundaryType type)
+{
+    switch (type)
+    {
+    case BoundaryType::Dirichlet:
+        return "dirichlet";
+    case BoundaryType::Neumann:
+        return "neumann";
+    case BoundaryType::Periodic:
+        return "periodic";
+    case BoundaryType::Robin:
+        return "robin";
+    default:
+        return "";
+    }
+}
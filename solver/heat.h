@@ -0,0 +1,38 @@
+#ifndef HEAT_H
+#define HEAT_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+constexpr double kRangeX = 10.0;
+constexpr double kRangeT = 1.0;
+
+enum class InitialProfile {Gauss, SuperGauss, Rectangle, Delta};
+enum class MethodType {Explicit, Implicit, CrankNicolson};
+// Conditions at both ends of the rod: fixed values, zero flux, the ends joined
+// into a ring, or convective loss u_n + beta*u = 0 along the outward normal
+enum class BoundaryType {Dirichlet, Neumann, Periodic, Robin};
+
+struct ErrorNorms
+{
+    double l1, l2, linf;
+};
+
+double initial(double x, InitialProfile profile, double ampl = 1.0);
+double amplitude(InitialProfile profile, double dx);
+std::pair<double, double> dispersion_diffusion(double q_N, double alpha, MethodType type);
+// von Neumann stability: no Fourier mode grows, i.e. the diffusion
+// coefficient stays non-negative at q_N = 0.5, the shortest wave of the grid,
+// where the amplification of every scheme peaks
+bool is_stable(double alpha, MethodType type);
+std::vector<double> exact(std::int64_t n, double t, InitialProfile profile, double ampl);
+// Same into a caller-provided buffer of n values
+void exact(std::int64_t n, double t, InitialProfile profile, double ampl, double *out);
+ErrorNorms error_norms(const double *state, const double *reference, std::int64_t n, double dx);
+
+const char *profile_name(InitialProfile profile);
+const char *method_name(MethodType type);
+const char *boundary_name(BoundaryType type);
+
+#endif // HEAT_H
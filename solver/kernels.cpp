@@ -0,0 +1,441 @@
+#include "kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include "compiler.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define HEAT_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+typedef void (*ExplicitKernel)(const double *, double *, std::size_t, double);
+typedef double (*ExplicitPeakKernel)(const double *, double *, std::size_t, double);
+
+// The peak kernels also accumulate u - u, which stays zero while every value
+// is finite and turns into NaN for the first infinity or NaN: max() alone
+// would drop NaNs depending on the operand order.
+static double finite_peak(double peak, double check)
+{
+    return (check == 0.0) ? peak : std::numeric_limits<double>::infinity();
+}
+
+HEAT_NO_CONTRACT
+static void explicit_step_scalar(const double *in, double *out, std::size_t n, double alpha)
+{
+    for (std::size_t i = 1; i < n-1; ++i)
+        out[i] = in[i] + alpha * (in[i+1] - 2.0*in[i] + in[i-1]);
+}
+
+HEAT_NO_CONTRACT
+static double explicit_step_peak_scalar(const double *in, double *out, std::size_t n, double alpha)
+{
+    double peak = 0.0, check = 0.0;
+    for (std::size_t i = 1; i < n-1; ++i)
+    {
+        const double u = in[i] + alpha * (in[i+1] - 2.0*in[i] + in[i-1]);
+        out[i] = u;
+        peak = std::max(peak, std::abs(u));
+        check += u - u;
+    }
+    return finite_peak(peak, check);
+}
+
+#ifdef HEAT_X86_DISPATCH
+__attribute__((target("avx2"))) HEAT_NO_CONTRACT
+static void explicit_step_avx2(const double *in, double *out, std::size_t n, double alpha)
+{
+    const __m256d a = _mm256_set1_pd(alpha);
+    const __m256d two = _mm256_set1_pd(2.0);
+
+    std::size_t i = 1;
+    for (; i + 4 <= n-1; i += 4)
+    {
+        __m256d c = _mm256_loadu_pd(in + i);
+        __m256d l = _mm256_loadu_pd(in + i - 1);
+        __m256d r = _mm256_loadu_pd(in + i + 1);
+        __m256d lap = _mm256_add_pd(_mm256_sub_pd(r, _mm256_mul_pd(two, c)), l);
+        _mm256_storeu_pd(out + i, _mm256_add_pd(c, _mm256_mul_pd(a, lap)));
+    }
+    for (; i < n-1; ++i)
+        out[i] = in[i] + alpha * (in[i+1] - 2.0*in[i] + in[i-1]);
+}
+
+__attribute__((target("avx2"))) HEAT_NO_CONTRACT
+static double explicit_step_peak_avx2(const double *in, double *out, std::size_t n, double alpha)
+{
+    const __m256d a = _mm256_set1_pd(alpha);
+    const __m256d two = _mm256_set1_pd(2.0);
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    __m256d peak = _mm256_setzero_pd(), check = _mm256_setzero_pd();
+
+    std::size_t i = 1;
+    for (; i + 4 <= n-1; i += 4)
+    {
+        __m256d c = _mm256_loadu_pd(in + i);
+        __m256d l = _mm256_loadu_pd(in + i - 1);
+        __m256d r = _mm256_loadu_pd(in + i + 1);
+        __m256d lap = _mm256_add_pd(_mm256_sub_pd(r, _mm256_mul_pd(two, c)), l);
+        __m256d u = _mm256_add_pd(c, _mm256_mul_pd(a, lap));
+        _mm256_storeu_pd(out + i, u);
+        peak = _mm256_max_pd(peak, _mm256_andnot_pd(sign, u));
+        check = _mm256_add_pd(check, _mm256_sub_pd(u, u));
+    }
+
+    double lanes[4], checks[4];
+    _mm256_storeu_pd(lanes, peak);
+    _mm256_storeu_pd(checks, check);
+    double p = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    double chk = (checks[0] + checks[1]) + (checks[2] + checks[3]);
+    for (; i < n-1; ++i)
+    {
+        const double u = in[i] + alpha * (in[i+1] - 2.0*in[i] + in[i-1]);
+        out[i] = u;
+        p = std::max(p, std::abs(u));
+        chk += u - u;
+    }
+    return finite_peak(p, chk);
+}
+
+__attribute__((target("avx512f"))) HEAT_NO_CONTRACT
+static void explicit_step_avx512(const double *in, double *out, std::size_t n, double alpha)
+{
+    const __m512d a = _mm512_set1_pd(alpha);
+    const __m512d two = _mm512_set1_pd(2.0);
+
+    std::size_t i = 1;
+    for (; i + 8 <= n-1; i += 8)
+    {
+        __m512d c = _mm512_loadu_pd(in + i);
+        __m512d l = _mm512_loadu_pd(in + i - 1);
+        __m512d r = _mm512_loadu_pd(in + i + 1);
+        __m512d lap = _mm512_add_pd(_mm512_sub_pd(r, _mm512_mul_pd(two, c)), l);
+        _mm512_storeu_pd(out + i, _mm512_add_pd(c, _mm512_mul_pd(a, lap)));
+    }
+    for (; i < n-1; ++i)
+        out[i] = in[i] + alpha * (in[i+1] - 2.0*in[i] + in[i-1]);
+}
+
+__attribute__((target("avx512f"))) HEAT_NO_CONTRACT
+static double explicit_step_peak_avx512(const double *in, double *out, std::size_t n, double alpha)
+{
+    const __m512d a = _mm512_set1_pd(alpha);
+    const __m512d two = _mm512_set1_pd(2.0);
+    __m512d peak = _mm512_setzero_pd(), check = _mm512_setzero_pd();
+
+    std::size_t i = 1;
+    for (; i + 8 <= n-1; i += 8)
+    {
+        __m512d c = _mm512_loadu_pd(in + i);
+        __m512d l = _mm512_loadu_pd(in + i - 1);
+        __m512d r = _mm512_loadu_pd(in + i + 1);
+        __m512d lap = _mm512_add_pd(_mm512_sub_pd(r, _mm512_mul_pd(two, c)), l);
+        __m512d u = _mm512_add_pd(c, _mm512_mul_pd(a, lap));
+        _mm512_storeu_pd(out + i, u);
+        peak = _mm512_mask_max_pd(peak, 0xFF, peak, _mm512_abs_pd(u));
+        check = _mm512_add_pd(check, _mm512_sub_pd(u, u));
+    }
+
+    double lanes[8], checks[8];
+    _mm512_storeu_pd(lanes, peak);
+    _mm512_storeu_pd(checks, check);
+    double p = 0.0, chk = 0.0;
+    for (int j = 0; j < 8; ++j)
+    {
+        p = std::max(p, lanes[j]);
+        chk += checks[j];
+    }
+    for (; i < n-1; ++i)
+    {
+        const double u = in[i] + alpha * (in[i+1] - 2.0*in[i] + in[i-1]);
+        out[i] = u;
+        p = std::max(p, std::abs(u));
+        chk += u - u;
+    }
+    return finite_peak(p, chk);
+}
+#endif
+
+struct ExplicitDispatch
+{
+    ExplicitKernel kernel;
+    ExplicitPeakKernel peak;
+    const char *name;
+};
+
+static ExplicitDispatch select_explicit_kernel()
+{
+#ifdef HEAT_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return ExplicitDispatch{explicit_step_avx512, explicit_step_peak_avx512, "avx512"};
+    if (__builtin_cpu_supports("avx2"))
+        return ExplicitDispatch{explicit_step_avx2, explicit_step_peak_avx2, "avx2"};
+#endif
+    return ExplicitDispatch{explicit_step_scalar, explicit_step_peak_scalar, "scalar"};
+}
+
+static const ExplicitDispatch &explicit_dispatch()
+{
+    static const ExplicitDispatch dispatch = select_explicit_kernel();
+    return dispatch;
+}
+
+void explicit_step(const double *in, double *out, std::size_t n, double alpha)
+{
+    explicit_dispatch().kernel(in, out, n, alpha);
+}
+
+double explicit_step_peak(const double *in, double *out, std::size_t n, double alpha)
+{
+    return explicit_dispatch().peak(in, out, n, alpha);
+}
+
+const char *explicit_kernel_name()
+{
+    return explicit_dispatch().name;
+}
+
+constexpr int kStencilLanes = 16;
+
+// Fixed-width block of the explicit update with in pointing one node left of
+// the first output; Accum is the type the stencil is evaluated in
+template <typename Real, typename Accum>
+HEAT_NO_CONTRACT
+static HEAT_INLINE void stencil_lanes(const Real *__restrict in, Real *__restrict out, Accum alpha)
+{
+    for (int j = 0; j < kStencilLanes; ++j)
+    {
+        const Accum c = in[j+1];
+        out[j] = static_cast<Real>(c + alpha * (Accum(in[j+2]) - Accum(2)*c + Accum(in[j])));
+    }
+}
+
+template <typename Real, typename Accum>
+HEAT_NO_CONTRACT
+static HEAT_INLINE void stencil_blocks(const Real *in, Real *out, std::size_t n, Accum alpha)
+{
+    std::size_t i = 1;
+    for (; i + kStencilLanes <= n-1; i += kStencilLanes)
+        stencil_lanes<Real, Accum>(in + i - 1, out + i, alpha);
+    for (; i < n-1; ++i)
+    {
+        const Accum c = in[i];
+        out[i] = static_cast<Real>(c + alpha * (Accum(in[i+1]) - Accum(2)*c + Accum(in[i-1])));
+    }
+}
+
+typedef void (*FloatKernel)(const float *, float *, std::size_t, float);
+typedef void (*MixedKernel)(const float *, float *, std::size_t, double);
+
+HEAT_NO_CONTRACT
+static void explicit_step_float_scalar(const float *in, float *out, std::size_t n, float alpha)
+{
+    stencil_blocks<float, float>(in, out, n, alpha);
+}
+
+HEAT_NO_CONTRACT
+static void explicit_step_mixed_scalar(const float *in, float *out, std::size_t n, double alpha)
+{
+    stencil_blocks<float, double>(in, out, n, alpha);
+}
+
+#ifdef HEAT_X86_DISPATCH
+__attribute__((target("avx2"))) HEAT_NO_CONTRACT
+static void explicit_step_float_avx2(const float *in, float *out, std::size_t n, float alpha)
+{
+    stencil_blocks<float, float>(in, out, n, alpha);
+}
+
+__attribute__((target("avx2"))) HEAT_NO_CONTRACT
+static void explicit_step_mixed_avx2(const float *in, float *out, std::size_t n, double alpha)
+{
+    stencil_blocks<float, double>(in, out, n, alpha);
+}
+#endif
+
+static bool has_avx2()
+{
+#ifdef HEAT_X86_DISPATCH
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+void explicit_step(const float *in, float *out, std::size_t n, float alpha)
+{
+#ifdef HEAT_X86_DISPATCH
+    static const FloatKernel kernel = has_avx2() ? explicit_step_float_avx2 : explicit_step_float_scalar;
+#else
+    static const FloatKernel kernel = explicit_step_float_scalar;
+#endif
+    kernel(in, out, n, alpha);
+}
+
+void explicit_step_mixed(const float *in, float *out, std::size_t n, double alpha)
+{
+#ifdef HEAT_X86_DISPATCH
+    static const MixedKernel kernel = has_avx2() ? explicit_step_mixed_avx2 : explicit_step_mixed_scalar;
+#else
+    static const MixedKernel kernel = explicit_step_mixed_scalar;
+#endif
+    kernel(in, out, n, alpha);
+}
+
+double max_abs(const double *u, std::size_t n)
+{
+    double peak = 0.0, check = 0.0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        peak = std::max(peak, std::abs(u[i]));
+        check += u[i] - u[i];
+    }
+    return finite_peak(peak, check);
+}
+
+void explicit_step_tiled(const double *in, double *out, std::size_t n, double alpha, int steps, std::size_t tile, double *scratch)
+{
+    explicit_step_tiled(in, out, n, alpha, steps, tile, scratch, 1, n-1);
+}
+
+void explicit_step_tiled(const double *in, double *out, std::size_t n, double alpha, int steps, std::size_t tile, double *scratch,
+                         std::size_t first, std::size_t last)
+{
+    const std::size_t halo = static_cast<std::size_t>(steps);
+    double *buf[2] = {scratch, scratch + tile + 2*halo};
+
+    for (std::size_t a = first; a < last; a += tile)
+    {
+        const std::size_t b = std::min(a + tile, last);
+        const std::size_t lo = (a > halo) ? a - halo : 0;
+        const std::size_t hi = std::min(b + halo, n);
+
+        std::memcpy(buf[0], in + lo, (hi - lo) * sizeof(double));
+        // Global boundary nodes are read but never written, seed them in both buffers
+        if (lo == 0)
+            buf[1][0] = in[0];
+        if (hi == n)
+            buf[1][n-1-lo] = in[n-1];
+
+        int src = 0;
+        for (std::size_t s = 1; s <= halo; ++s)
+        {
+            const std::size_t g0 = std::max(a - std::min(a, halo - s), std::size_t(1));
+            const std::size_t g1 = std::min(b + (halo - s), n-1);
+            explicit_step(buf[src] + (g0 - lo) - 1, buf[1-src] + (g0 - lo) - 1, g1 - g0 + 2, alpha);
+            src = 1 - src;
+        }
+
+        std::memcpy(out + a, buf[src] + (a - lo), (b - a) * sizeof(double));
+    }
+}
+
+std::size_t explicit_tiled_scratch_size(std::size_t tile, int steps)
+{
+    return 2 * (tile + 2*static_cast<std::size_t>(steps));
+}
+
+constexpr std::size_t kExpLanes = 8;
+
+// exp(x) = 2^k * exp(r), r = x - k*ln2 in [-ln2/2, ln2/2]: k is rounded with
+// the 1.5*2^52 shifter, ln2 is split in two parts (Cody-Waite) and exp(r) is
+// the Taylor series through r^13. Arguments are clamped to -708 so 2^k stays
+// a normal number; anything smaller returns zero.
+HEAT_NO_TRAPPING
+static HEAT_INLINE double exp_lane(double x)
+{
+    const double kLog2e = 1.4426950408889634;
+    const double kLn2Hi = 6.93147180369123816490e-01;
+    const double kLn2Lo = 1.90821492927058770002e-10;
+    const double kShifter = 6755399441055744.0;
+
+    const double clamped = (x < -708.0) ? -708.0 : x;
+    const double shifted = clamped * kLog2e + kShifter;
+    std::uint64_t bits;
+    std::memcpy(&bits, &shifted, sizeof(bits));
+    const double k = shifted - kShifter;
+    const double r = (clamped - k * kLn2Hi) - k * kLn2Lo;
+
+    double p = 1.0 / 6227020800.0;
+    p = p * r + 1.0 / 479001600.0;
+    p = p * r + 1.0 / 39916800.0;
+    p = p * r + 1.0 / 3628800.0;
+    p = p * r + 1.0 / 362880.0;
+    p = p * r + 1.0 / 40320.0;
+    p = p * r + 1.0 / 5040.0;
+    p = p * r + 1.0 / 720.0;
+    p = p * r + 1.0 / 120.0;
+    p = p * r + 1.0 / 24.0;
+    p = p * r + 1.0 / 6.0;
+    p = p * r + 0.5;
+    p = p * r + 1.0;
+    p = p * r + 1.0;
+
+    // The low bits of the shifted value hold k in two's complement
+    const std::uint64_t scale_bits = (bits + 1023) << 52;
+    double scale;
+    std::memcpy(&scale, &scale_bits, sizeof(scale));
+    return (x < -708.0) ? 0.0 : p * scale;
+}
+
+HEAT_NO_TRAPPING
+static HEAT_INLINE void gaussian_lanes(double *__restrict out, double x0, double h, double inv_width2, double factor)
+{
+    for (int j = 0; j < int(kExpLanes); ++j)
+    {
+        const double x = x0 + j * h;
+        out[j] = factor * exp_lane(-x*x * inv_width2);
+    }
+}
+
+typedef void (*GaussianKernel)(double *, std::size_t, double, double, double, double);
+
+HEAT_NO_TRAPPING
+static HEAT_INLINE void gaussian_blocks(double *out, std::size_t n, double x0, double h, double inv_width2, double factor)
+{
+    std::size_t i = 0;
+    for (; i + kExpLanes <= n; i += kExpLanes)
+        gaussian_lanes(out + i, x0 + double(i) * h, h, inv_width2, factor);
+    for (; i < n; ++i)
+    {
+        const double x = x0 + double(i) * h;
+        out[i] = factor * exp_lane(-x*x * inv_width2);
+    }
+}
+
+HEAT_NO_TRAPPING
+static void gaussian_scalar(double *out, std::size_t n, double x0, double h, double inv_width2, double factor)
+{
+    gaussian_blocks(out, n, x0, h, inv_width2, factor);
+}
+
+#ifdef HEAT_X86_DISPATCH
+// Same code built for wider vectors; without FMA the rounding is unchanged
+__attribute__((target("avx2"))) HEAT_NO_TRAPPING
+static void gaussian_avx2(double *out, std::size_t n, double x0, double h, double inv_width2, double factor)
+{
+    gaussian_blocks(out, n, x0, h, inv_width2, factor);
+}
+#endif
+
+static GaussianKernel select_gaussian_kernel()
+{
+#ifdef HEAT_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return gaussian_avx2;
+#endif
+    return gaussian_scalar;
+}
+
+void gaussian(double *out, std::size_t n, double x0, double h, double inv_width2, double factor)
+{
+    static const GaussianKernel kernel = select_gaussian_kernel();
+    kernel(out, n, x0, h, inv_width2, factor);
+}
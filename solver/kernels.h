@@ -0,0 +1,44 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <cstddef>
+
+// Explicit (FTCS) update of the interior nodes 1..n-2:
+//     out[i] = in[i] + alpha * (in[i+1] - 2*in[i] + in[i-1])
+// Boundary nodes are left untouched. The implementation (scalar, AVX2 or
+// AVX-512) is picked once at startup from CPUID; every variant performs the
+// same operations in the same order and gives bit-identical results.
+void explicit_step(const double *in, double *out, std::size_t n, double alpha);
+// Same update that also returns the largest |out[i]| of the interior nodes,
+// tracked in registers while the nodes are written; +inf once any of them
+// is not finite. The output is bit-identical to explicit_step().
+double explicit_step_peak(const double *in, double *out, std::size_t n, double alpha);
+const char *explicit_kernel_name();
+// Single precision state for the same update: the float kernel works in float
+// throughout (eight nodes per AVX2 register instead of four), the mixed one
+// loads float, evaluates the stencil in double and rounds once per node.
+void explicit_step(const float *in, float *out, std::size_t n, float alpha);
+void explicit_step_mixed(const float *in, float *out, std::size_t n, double alpha);
+// Largest |u[i]| over [0, n), +inf once any value is not finite
+double max_abs(const double *u, std::size_t n);
+
+// Advances the explicit scheme by `steps` time steps from in to out with
+// overlapped temporal tiling: every tile of `tile` nodes is loaded once together
+// with a halo of `steps` nodes on each side and advanced `steps` times while it
+// stays cache resident. Halo nodes are recomputed by neighbouring tiles, so the
+// result is bit-identical to calling explicit_step() `steps` times.
+// out must already hold the boundary nodes; scratch must hold
+// explicit_tiled_scratch_size(tile, steps) doubles. The second overload only
+// produces the output nodes [first, last), which lets threads share the grid.
+void explicit_step_tiled(const double *in, double *out, std::size_t n, double alpha, int steps, std::size_t tile, double *scratch);
+void explicit_step_tiled(const double *in, double *out, std::size_t n, double alpha, int steps, std::size_t tile, double *scratch,
+                         std::size_t first, std::size_t last);
+std::size_t explicit_tiled_scratch_size(std::size_t tile, int steps);
+
+// Gaussian on a uniform grid, out[i] = factor * exp(-x*x * inv_width2) with
+// x = x0 + i*h. exp() is a branch-free polynomial evaluated over fixed-width
+// blocks, so the loop vectorizes; it agrees with std::exp to about 1 ulp and
+// flushes results below 1e-307 to zero.
+void gaussian(double *out, std::size_t n, double x0, double h, double inv_width2, double factor);
+
+#endif // KERNELS_H
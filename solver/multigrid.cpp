@@ -0,0 +1,302 @@
+#include "multigrid.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+
+// Levels smaller than this are not worth waking the pool for
+constexpr std::size_t kMinParallelRows = 64;
+
+// Interior index range along an axis, the single node of an unused axis included
+static std::size_t first(std::size_t n)
+{
+    return (n > 1) ? 1 : 0;
+}
+
+static std::size_t last(std::size_t n)
+{
+    return (n > 1) ? n-1 : 1;
+}
+
+// Coarse node m sits at m*(n-1)/(nc-1) in fine node units. Prolongation is
+// linear interpolation there; restriction is its transpose times the spacing
+// ratio, so it averages like full weighting (exactly full weighting when the
+// fine cells are even and the grids nest).
+Multigrid::Transfer Multigrid::make_transfer(std::size_t n, std::size_t nc)
+{
+    Transfer transfer;
+    transfer.lo.resize(n);
+    transfer.w.resize(n);
+    const std::size_t cells = std::max<std::size_t>(n-1, 1), coarse_cells = std::max<std::size_t>(nc-1, 1);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        transfer.lo[i] = i * coarse_cells / cells;
+        transfer.w[i] = double(i * coarse_cells - transfer.lo[i] * cells) / double(cells);
+    }
+
+    const double scale = double(coarse_cells) / double(cells);
+    std::vector<std::vector<std::pair<std::size_t, double>>> gather(nc);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        gather[transfer.lo[i]].emplace_back(i, (1.0 - transfer.w[i]) * scale);
+        if (transfer.w[i] > 0.0)
+            gather[transfer.lo[i]+1].emplace_back(i, transfer.w[i] * scale);
+    }
+    transfer.begin.push_back(0);
+    for (const auto &entries: gather)
+    {
+        for (const auto &entry: entries)
+        {
+            transfer.index.push_back(entry.first);
+            transfer.weight.push_back(entry.second);
+        }
+        transfer.begin.push_back(transfer.index.size());
+    }
+    return transfer;
+}
+
+Multigrid::Multigrid()
+    : pool_(nullptr)
+{}
+
+Multigrid::Multigrid(const std::array<std::size_t, 3> &n, const std::array<double, 3> &c)
+    : pool_(nullptr)
+{
+    Level level;
+    level.n = n;
+    level.c = c;
+    for (;;)
+    {
+        level.diag = 1.0;
+        for (int a = 0; a < 3; ++a)
+        {
+            if (level.n[a] == 1)
+                level.c[a] = 0.0;
+            level.diag += 2.0*level.c[a];
+        }
+        // The finest level works in the caller's buffers
+        std::size_t size = level.n[0] * level.n[1] * level.n[2];
+        if (!levels_.empty())
+        {
+            level.x.assign(size, 0.0);
+            level.rhs.assign(size, 0.0);
+        }
+        level.res.assign(size, 0.0);
+        levels_.push_back(level);
+
+        // Axes below five nodes keep their size, the others halve their cells
+        std::array<std::size_t, 3> coarse = level.n;
+        bool coarsen = false;
+        for (int a = 0; a < 3; ++a)
+            if (level.n[a] >= 5)
+            {
+                coarse[a] = level.n[a]/2 + 1;
+                coarsen = true;
+            }
+        if (!coarsen)
+            break;
+
+        for (int a = 0; a < 3; ++a)
+        {
+            levels_.back().to_coarse[a] = make_transfer(level.n[a], coarse[a]);
+            const double ratio = double(coarse[a]-1) / double(level.n[a]-1);
+            if (level.n[a] > 1)
+                level.c[a] *= ratio*ratio;
+            level.n[a] = coarse[a];
+        }
+    }
+}
+
+std::size_t Multigrid::size() const
+{
+    return levels_.empty() ? 0 : levels_[0].res.size();
+}
+
+std::size_t Multigrid::levels() const
+{
+    return levels_.size();
+}
+
+void Multigrid::set_pool(ThreadPool *pool)
+{
+    pool_ = pool;
+}
+
+int Multigrid::solve(const double *rhs, double *x, double tol, int max_cycles) const
+{
+    const Level &fine = levels_[0];
+    const std::size_t nx = fine.n[0], ny = fine.n[1], nz = fine.n[2];
+
+    double norm = 0.0;
+    for (std::size_t k = 0; k < nz; ++k)
+        for (std::size_t j = 0; j < ny; ++j)
+            for (std::size_t i = 0; i < nx; ++i)
+            {
+                std::size_t idx = i + nx*(j + ny*k);
+                norm = std::max(norm, std::abs(rhs[idx]));
+                bool face = (nx > 1 && (i == 0 || i == nx-1)) || (ny > 1 && (j == 0 || j == ny-1)) || (nz > 1 && (k == 0 || k == nz-1));
+                if (face)
+                    x[idx] = rhs[idx];
+            }
+
+    for (int cycles = 0; ; ++cycles)
+    {
+        if (residual(fine, x, rhs, fine.res.data()) <= tol * norm)
+            return cycles;
+        if (cycles == max_cycles)
+            throw std::runtime_error("multigrid did not reach the tolerance in the cycle limit");
+        cycle(0, x, rhs);
+    }
+}
+
+template <typename Job>
+void Multigrid::for_rows(const Level &level, Job job) const
+{
+    const std::size_t rows = (last(level.n[1]) - first(level.n[1])) * (last(level.n[2]) - first(level.n[2]));
+    if (!pool_ || rows < kMinParallelRows)
+    {
+        job(std::size_t(0), rows);
+        return;
+    }
+
+    const std::size_t threads = pool_->size();
+    pool_->run([&](int index)
+    {
+        job(rows * index / threads, rows * (index+1) / threads);
+    });
+}
+
+void Multigrid::smooth(const Level &level, double *x, const double *rhs, int sweeps) const
+{
+    const std::size_t nx = level.n[0], ny = level.n[1];
+    const std::size_t sy = (ny > 1) ? nx : 0, sz = (level.n[2] > 1) ? nx*ny : 0;
+    const std::size_t jy = first(ny), cy_rows = last(ny) - jy, kz = first(level.n[2]);
+    const double cx = level.c[0], cy = level.c[1], cz = level.c[2];
+    const double inv_diag = 1.0 / level.diag;
+
+    for (int sweep = 0; sweep < sweeps; ++sweep)
+        for (std::size_t color = 0; color < 2; ++color)
+            for_rows(level, [&](std::size_t begin, std::size_t end)
+            {
+                for (std::size_t r = begin; r < end; ++r)
+                {
+                    const std::size_t j = jy + r % cy_rows, k = kz + r / cy_rows;
+                    double *row = x + nx*(j + ny*k);
+                    const double *f = rhs + nx*(j + ny*k);
+                    for (std::size_t i = 1 + ((color + 1 + j + k) & 1); i < nx-1; i += 2)
+                        row[i] = (f[i] + cx*(row[i-1] + row[i+1]) + cy*(row[i-sy] + row[i+sy]) + cz*(row[i-sz] + row[i+sz])) * inv_diag;
+                }
+            });
+}
+
+double Multigrid::residual(const Level &level, const double *x, const double *rhs, double *res) const
+{
+    const std::size_t nx = level.n[0], ny = level.n[1];
+    const std::size_t sy = (ny > 1) ? nx : 0, sz = (level.n[2] > 1) ? nx*ny : 0;
+    const std::size_t jy = first(ny), cy_rows = last(ny) - jy, kz = first(level.n[2]);
+    const double cx = level.c[0], cy = level.c[1], cz = level.c[2], diag = level.diag;
+
+    std::vector<double> norms(pool_ ? pool_->size() : 1, 0.0);
+    std::atomic<int> next(0);
+    for_rows(level, [&](std::size_t begin, std::size_t end)
+    {
+        double norm = 0.0;
+        for (std::size_t r = begin; r < end; ++r)
+        {
+            const std::size_t row = nx*((jy + r % cy_rows) + ny*(kz + r / cy_rows));
+            for (std::size_t i = row+1; i < row+nx-1; ++i)
+            {
+                res[i] = rhs[i] - diag*x[i] + cx*(x[i-1] + x[i+1]) + cy*(x[i-sy] + x[i+sy]) + cz*(x[i-sz] + x[i+sz]);
+                norm = std::max(norm, std::abs(res[i]));
+            }
+        }
+        norms[next++] = norm;
+    });
+    return *std::max_element(norms.begin(), norms.end());
+}
+
+void Multigrid::restrict_to(const Level &fine, const double *res, const Level &coarse, double *rhs) const
+{
+    const std::size_t nx = fine.n[0], ny = fine.n[1];
+    const std::size_t cnx = coarse.n[0], cny = coarse.n[1];
+    const std::size_t jy = first(cny), cy_rows = last(cny) - jy, kz = first(coarse.n[2]);
+    const Transfer &tx = fine.to_coarse[0], &ty = fine.to_coarse[1], &tz = fine.to_coarse[2];
+
+    for_rows(coarse, [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t r = begin; r < end; ++r)
+        {
+            const std::size_t j = jy + r % cy_rows, k = kz + r / cy_rows;
+            double *out = rhs + cnx*(j + cny*k);
+            for (std::size_t i = 1; i < cnx-1; ++i)
+                out[i] = 0.0;
+            for (std::size_t ez = tz.begin[k]; ez < tz.begin[k+1]; ++ez)
+                for (std::size_t ey = ty.begin[j]; ey < ty.begin[j+1]; ++ey)
+                {
+                    const double *f = res + nx*(ty.index[ey] + ny*tz.index[ez]);
+                    const double w = ty.weight[ey] * tz.weight[ez];
+                    for (std::size_t i = 1; i < cnx-1; ++i)
+                    {
+                        double sum = 0.0;
+                        for (std::size_t ex = tx.begin[i]; ex < tx.begin[i+1]; ++ex)
+                            sum += tx.weight[ex] * f[tx.index[ex]];
+                        out[i] += w * sum;
+                    }
+                }
+        }
+    });
+}
+
+void Multigrid::prolong_add(const Level &coarse, const double *x, const Level &fine, double *out) const
+{
+    const std::size_t nx = fine.n[0], ny = fine.n[1], nz = fine.n[2];
+    const std::size_t cnx = coarse.n[0], cny = coarse.n[1];
+    const std::size_t jy = first(ny), cy_rows = last(ny) - jy, kz = first(nz);
+    const Transfer &tx = fine.to_coarse[0], &ty = fine.to_coarse[1], &tz = fine.to_coarse[2];
+
+    for_rows(fine, [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t r = begin; r < end; ++r)
+        {
+            const std::size_t j = jy + r % cy_rows, k = kz + r / cy_rows;
+            double *row = out + nx*(j + ny*k);
+            // Up to two coarse rows along y and z, zero weights skipped
+            for (std::size_t b = 0; b < 2; ++b)
+            {
+                const double wz = b ? tz.w[k] : 1.0 - tz.w[k];
+                if (wz == 0.0)
+                    continue;
+                for (std::size_t a = 0; a < 2; ++a)
+                {
+                    const double wy = a ? ty.w[j] : 1.0 - ty.w[j];
+                    if (wy == 0.0)
+                        continue;
+                    const double *c = x + cnx*((ty.lo[j] + a) + cny*(tz.lo[k] + b));
+                    const double w = wy * wz;
+                    for (std::size_t i = 1; i < nx-1; ++i)
+                        row[i] += w * ((1.0 - tx.w[i]) * c[tx.lo[i]] + tx.w[i] * c[tx.lo[i]+1]);
+                }
+            }
+        }
+    });
+}
+
+void Multigrid::cycle(std::size_t l, double *x, const double *rhs) const
+{
+    const Level &level = levels_[l];
+    if (l+1 == levels_.size())
+    {
+        smooth(level, x, rhs, kCoarsestSweeps);
+        return;
+    }
+
+    const Level &coarse = levels_[l+1];
+    smooth(level, x, rhs, kPreSmooth);
+    residual(level, x, rhs, level.res.data());
+    restrict_to(level, level.res.data(), coarse, coarse.rhs.data());
+    std::fill(coarse.x.begin(), coarse.x.end(), 0.0);
+    cycle(l+1, coarse.x.data(), coarse.rhs.data());
+    prolong_add(coarse, coarse.x.data(), level, x);
+    smooth(level, x, rhs, kPostSmooth);
+}
@@ -0,0 +1,84 @@
+#ifndef MULTIGRID_H
+#define MULTIGRID_H
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "aligned.h"
+#include "threadpool.h"
+
+// Geometric multigrid for the implicit heat operator on a box of up to three
+// dimensions with Dirichlet faces:
+//     (1 + 2*sum_a c[a]) x[i] - sum_a c[a] (x[i+s_a] + x[i-s_a]) = rhs[i]
+// on interior nodes and x[i] = rhs[i] on the faces, with c[a] = theta*dt/dx_a^2.
+// Storage is x fastest, then y, then z; unused axes have size 1.
+// Every V-cycle does red-black Gauss-Seidel smoothing, full weighting
+// restriction and linear prolongation. Every axis of at least five nodes is
+// coarsened from m cells to ceil(m/2) spanning the same range, and the coarse
+// grids are rediscretized (c scales with the squared ratio of the spacings).
+// When m is even the coarse nodes sit on every other fine node; otherwise the
+// grids are not nested and prolongation interpolates linearly at the fine
+// positions, restriction being its transpose scaled by the spacing ratio.
+// Any size therefore coarsens down to a few nodes per axis; each cycle costs
+// O(N) and cuts the residual by a factor independent of N.
+class Multigrid
+{
+public:
+    Multigrid();
+    Multigrid(const std::array<std::size_t, 3> &n, const std::array<double, 3> &c);
+
+    std::size_t size() const;
+    std::size_t levels() const;
+
+    // Splits the rows of every sweep over the pool; nullptr runs serially
+    void set_pool(ThreadPool *pool);
+
+    // x holds the initial guess; its face values are overwritten from rhs.
+    // Cycles until the largest residual drops below tol times the largest
+    // |rhs| and returns the number of cycles done; throws std::runtime_error
+    // if that takes more than max_cycles
+    int solve(const double *rhs, double *x, double tol, int max_cycles) const;
+
+private:
+    // Grid transfer along one axis between a level and the next coarser one
+    struct Transfer
+    {
+        // Fine node i interpolates coarse nodes lo[i] and lo[i]+1 with weights
+        // 1-w[i] and w[i]
+        std::vector<std::size_t> lo;
+        std::vector<double> w;
+        // Coarse node m gathers the fine nodes index[e], e in [begin[m], begin[m+1]),
+        // with the weights weight[e]
+        std::vector<std::size_t> begin, index;
+        std::vector<double> weight;
+    };
+
+    struct Level
+    {
+        std::array<std::size_t, 3> n;
+        std::array<double, 3> c;
+        double diag;
+        std::array<Transfer, 3> to_coarse;
+        mutable AlignedVector x, rhs, res;
+    };
+
+    static constexpr int kPreSmooth = 2;
+    static constexpr int kPostSmooth = 2;
+    static constexpr int kCoarsestSweeps = 64;
+
+    std::vector<Level> levels_;
+    ThreadPool *pool_;
+
+    static Transfer make_transfer(std::size_t n, std::size_t nc);
+    // Calls job(first, last) on ranges of the level's interior rows (y, z pairs)
+    template <typename Job>
+    void for_rows(const Level &level, Job job) const;
+    void smooth(const Level &level, double *x, const double *rhs, int sweeps) const;
+    double residual(const Level &level, const double *x, const double *rhs, double *res) const;
+    void restrict_to(const Level &fine, const double *res, const Level &coarse, double *rhs) const;
+    void prolong_add(const Level &coarse, const double *x, const Level &fine, double *out) const;
+    void cycle(std::size_t l, double *x, const double *rhs) const;
+};
+
+#endif // MULTIGRID_H
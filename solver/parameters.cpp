@@ -1,17 +1,17 @@
 #include "parameters.h"
 
-Parameters::Parameters(int nx, int nt, double range_x, double range_t)
+Parameters::Parameters(std::int64_t nx, std::int64_t nt, double range_x, double range_t)
     : nx_(nx), nt_(nt), range_x_(range_x), range_t_(range_t)
 {
     set_alpha();
 }
 
-int Parameters::get_nx() const
+std::int64_t Parameters::get_nx() const
 {
     return nx_;
 }
 
-int Parameters::get_nt() const
+std::int64_t Parameters::get_nt() const
 {
     return nt_;
 }
@@ -26,18 +26,28 @@ double Parameters::get_dt() const
     return range_t_ / nt_;
 }
 
+double Parameters::get_range_x() const
+{
+    return range_x_;
+}
+
+double Parameters::get_range_t() const
+{
+    return range_t_;
+}
+
 double Parameters::get_alpha() const
 {
     return alpha_;
 }
 
-void Parameters::set_nx(double nx)
+void Parameters::set_nx(std::int64_t nx)
 {
     nx_ = nx;
     set_alpha();
 }
 
-void Parameters::set_nt(double nt)
+void Parameters::set_nt(std::int64_t nt)
 {
     nt_ = nt;
     set_alpha();
@@ -1,28 +1,32 @@
 #ifndef PARAMETERS_H
 #define PARAMETERS_H
 
+#include <cstdint>
+
 #include <QString>
 
 class Parameters
 {
 public:
-    Parameters(int nx, int nt, double range_x, double range_t);
+    Parameters(std::int64_t nx, std::int64_t nt, double range_x, double range_t);
 
-    int get_nx() const;
-    int get_nt() const;
+    std::int64_t get_nx() const;
+    std::int64_t get_nt() const;
     double get_dx() const;
     double get_dt() const;
+    double get_range_x() const;
+    double get_range_t() const;
     double get_alpha() const;
 
-    void set_nx(double nx);
-    void set_nt(double nt);
+    void set_nx(std::int64_t nx);
+    void set_nt(std::int64_t nt);
     void set_range_x(double range_x);
     void set_range_t(double range_t);
 
     QString toQString() const;
 
 private:
-    int nx_, nt_;
+    std::int64_t nx_, nt_;
     double range_x_, range_t_;
     double alpha_;
 
@@ -0,0 +1,256 @@
+#include "profiler.h"
+
+#include <cinttypes>
+#include <cstring>
+#include <mutex>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static const char *const kPhaseNames[kPhases] = {"step", "tdma_forward", "tdma_backward", "exact", "plot"};
+
+// Written by its own thread only, read by report(): relaxed loads and stores
+// are enough and keep the hot path free of locked instructions
+struct ThreadCounters
+{
+    std::atomic<std::uint64_t> ticks[kPhases], calls[kPhases], steps[kPhases], points[kPhases];
+
+    ThreadCounters()
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        for (int p = 0; p < kPhases; ++p)
+        {
+            ticks[p].store(0, std::memory_order_relaxed);
+            calls[p].store(0, std::memory_order_relaxed);
+            steps[p].store(0, std::memory_order_relaxed);
+            points[p].store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+static void bump(std::atomic<std::uint64_t> &counter, std::uint64_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+struct Registry
+{
+    Registry()
+        : start_ticks(0), stop_ticks(0), counters{-1, -1, -1}
+    {}
+
+    std::mutex mutex;
+    std::vector<ThreadCounters *> live;
+    ThreadCounters retired;   // totals of the threads that have exited
+
+    std::chrono::steady_clock::time_point start, stop;
+    std::uint64_t start_ticks, stop_ticks;
+    int counters[3];
+};
+
+static Registry &registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+// Registers the counters of a thread on first use and folds them into the
+// retired totals when the thread exits
+struct ThreadSlot
+{
+    ThreadCounters counters;
+
+    ThreadSlot()
+    {
+        Registry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.live.push_back(&counters);
+    }
+
+    ~ThreadSlot()
+    {
+        Registry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (int p = 0; p < kPhases; ++p)
+        {
+            bump(reg.retired.ticks[p], counters.ticks[p].load(std::memory_order_relaxed));
+            bump(reg.retired.calls[p], counters.calls[p].load(std::memory_order_relaxed));
+            bump(reg.retired.steps[p], counters.steps[p].load(std::memory_order_relaxed));
+            bump(reg.retired.points[p], counters.points[p].load(std::memory_order_relaxed));
+        }
+        for (std::size_t i = 0; i < reg.live.size(); ++i)
+        {
+            if (reg.live[i] == &counters)
+            {
+                reg.live.erase(reg.live.begin() + i);
+                break;
+            }
+        }
+    }
+};
+
+static ThreadCounters &local_counters()
+{
+    thread_local ThreadSlot slot;
+    return slot.counters;
+}
+
+std::atomic<bool> Profiler::enabled_(false);
+
+#if defined(__linux__)
+static int open_counter(std::uint64_t config)
+{
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast<int>(::syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+static std::uint64_t read_counter(int fd)
+{
+    std::uint64_t value = 0;
+    if (fd < 0 || ::read(fd, &value, sizeof(value)) != static_cast<ssize_t>(sizeof(value)))
+        return 0;
+    return value;
+}
+#endif
+
+static void close_counters(Registry &reg)
+{
+    for (int &fd: reg.counters)
+    {
+#if defined(__linux__)
+        if (fd >= 0)
+            ::close(fd);
+#endif
+        fd = -1;
+    }
+}
+
+void Profiler::enable(bool hardware)
+{
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (ThreadCounters *counters: reg.live)
+        counters->clear();
+    reg.retired.clear();
+
+    close_counters(reg);
+#if defined(__linux__)
+    if (hardware)
+    {
+        reg.counters[0] = open_counter(PERF_COUNT_HW_CPU_CYCLES);
+        reg.counters[1] = open_counter(PERF_COUNT_HW_INSTRUCTIONS);
+        reg.counters[2] = open_counter(PERF_COUNT_HW_CACHE_MISSES);
+    }
+#else
+    (void)hardware;
+#endif
+
+    reg.start = reg.stop = std::chrono::steady_clock::now();
+    reg.start_ticks = reg.stop_ticks = ticks();
+    enabled_.store(true);
+}
+
+void Profiler::disable()
+{
+    if (!enabled_.exchange(false))
+        return;
+
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.stop = std::chrono::steady_clock::now();
+    reg.stop_ticks = ticks();
+}
+
+void Profiler::add(Phase phase, std::uint64_t ticks, std::uint64_t steps, std::uint64_t points)
+{
+    ThreadCounters &counters = local_counters();
+    const int p = static_cast<int>(phase);
+    bump(counters.ticks[p], ticks);
+    bump(counters.calls[p], 1);
+    bump(counters.steps[p], steps);
+    bump(counters.points[p], points);
+}
+
+ProfileReport Profiler::report()
+{
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    std::chrono::steady_clock::time_point stop = reg.stop;
+    std::uint64_t stop_ticks = reg.stop_ticks;
+    if (enabled_)
+    {
+        stop = std::chrono::steady_clock::now();
+        stop_ticks = ticks();
+    }
+
+    ProfileReport res;
+    res.seconds = std::chrono::duration<double>(stop - reg.start).count();
+    // Ticks are TSC cycles or nanoseconds, either way calibrated on the run
+    const double seconds_per_tick = (stop_ticks > reg.start_ticks && res.seconds > 0.0)
+            ? res.seconds / double(stop_ticks - reg.start_ticks) : 1e-9;
+
+    for (int p = 0; p < kPhases; ++p)
+    {
+        std::uint64_t ticks = reg.retired.ticks[p].load(std::memory_order_relaxed);
+        PhaseTiming timing = {kPhaseNames[p], reg.retired.calls[p].load(std::memory_order_relaxed),
+                              reg.retired.steps[p].load(std::memory_order_relaxed),
+                              reg.retired.points[p].load(std::memory_order_relaxed), 0.0};
+        for (ThreadCounters *counters: reg.live)
+        {
+            ticks += counters->ticks[p].load(std::memory_order_relaxed);
+            timing.calls += counters->calls[p].load(std::memory_order_relaxed);
+            timing.steps += counters->steps[p].load(std::memory_order_relaxed);
+            timing.points += counters->points[p].load(std::memory_order_relaxed);
+        }
+        timing.seconds = ticks * seconds_per_tick;
+        res.phases.push_back(timing);
+    }
+
+    res.hardware.available = false;
+    res.hardware.cycles = res.hardware.instructions = res.hardware.cache_misses = 0;
+#if defined(__linux__)
+    if (reg.counters[0] >= 0)
+    {
+        res.hardware.available = true;
+        res.hardware.cycles = read_counter(reg.counters[0]);
+        res.hardware.instructions = read_counter(reg.counters[1]);
+        res.hardware.cache_misses = read_counter(reg.counters[2]);
+    }
+#endif
+    return res;
+}
+
+void Profiler::print(std::FILE *out)
+{
+    const ProfileReport res = report();
+    const std::uint64_t steps = res.phases[static_cast<int>(Phase::Step)].steps;
+
+    std::fprintf(out, "profile: %.3f s wall, %" PRIu64 " steps; phase times are summed over threads\n", res.seconds, steps);
+    std::fprintf(out, "%-14s %10s %12s %12s %14s\n", "phase", "calls", "seconds", "ns/step", "points/s");
+    for (const PhaseTiming &timing: res.phases)
+    {
+        if (timing.calls == 0)
+            continue;
+        std::fprintf(out, "%-14s %10" PRIu64 " %12.6f %12.1f %14.4g\n", timing.name, timing.calls, timing.seconds,
+                     steps ? timing.seconds / steps * 1e9 : 0.0, timing.seconds > 0.0 ? timing.points / timing.seconds : 0.0);
+    }
+    if (res.hardware.available)
+        std::fprintf(out, "hardware: %" PRIu64 " cycles, %" PRIu64 " instructions (%.2f per cycle), %" PRIu64 " cache misses\n",
+                     res.hardware.cycles, res.hardware.instructions,
+                     res.hardware.cycles ? double(res.hardware.instructions) / res.hardware.cycles : 0.0, res.hardware.cache_misses);
+}
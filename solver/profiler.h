@@ -0,0 +1,108 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define HEAT_PROFILE_TSC
+#include <x86intrin.h>
+#endif
+
+// Hot-path phases timed by HEAT_PROFILE. Phases nest: the Thomas sweeps are
+// part of Step, Exact is part of Plot when the GUI builds the error curve.
+enum class Phase {Step, TdmaForward, TdmaBackward, Exact, Plot};
+constexpr int kPhases = 5;
+
+struct PhaseTiming
+{
+    const char *name;
+    std::uint64_t calls;
+    std::uint64_t steps;    // time steps covered, only Step counts them
+    std::uint64_t points;   // grid points processed
+    double seconds;
+};
+
+struct HardwareCounters
+{
+    bool available;
+    std::uint64_t cycles, instructions, cache_misses;
+};
+
+struct ProfileReport
+{
+    std::vector<PhaseTiming> phases;
+    double seconds;         // wall time since enable()
+    HardwareCounters hardware;
+};
+
+// Process-wide phase timer. Every thread accumulates into its own counters,
+// so timing adds no shared-memory traffic; report() sums them. Scopes read
+// the time stamp counter where there is one (calibrated against
+// steady_clock), steady_clock otherwise. While disabled a scope costs one
+// predictable branch; building with HEAT_NO_PROFILING removes them entirely.
+class Profiler
+{
+public:
+    // Resets all counters. hardware also counts cycles, instructions and
+    // cache misses of the whole process through perf_event_open (Linux, and
+    // only threads started after this call).
+    static void enable(bool hardware = false);
+    static void disable();
+    static bool is_enabled()
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    static void add(Phase phase, std::uint64_t ticks, std::uint64_t steps, std::uint64_t points);
+    static std::uint64_t ticks()
+    {
+#ifdef HEAT_PROFILE_TSC
+        return __rdtsc();
+#else
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    static ProfileReport report();
+    // ns per time step and points per second of every phase that ran
+    static void print(std::FILE *out);
+
+private:
+    static std::atomic<bool> enabled_;
+};
+
+class ProfileScope
+{
+public:
+    ProfileScope(Phase phase, std::uint64_t steps, std::uint64_t points)
+        : phase_(phase), steps_(steps), points_(points), start_(Profiler::is_enabled() ? Profiler::ticks() : 0)
+    {}
+    ~ProfileScope()
+    {
+        if (start_ != 0)
+            Profiler::add(phase_, Profiler::ticks() - start_, steps_, points_);
+    }
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    Phase phase_;
+    std::uint64_t steps_, points_, start_;
+};
+
+#define HEAT_PROFILE_CONCAT2(a, b) a##b
+#define HEAT_PROFILE_CONCAT(a, b) HEAT_PROFILE_CONCAT2(a, b)
+#ifdef HEAT_NO_PROFILING
+#define HEAT_PROFILE(phase, steps, points) ((void)0)
+#else
+#define HEAT_PROFILE(phase, steps, points) \
+    ProfileScope HEAT_PROFILE_CONCAT(profile_scope_, __LINE__)(phase, steps, points)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,170 @@
+#include "scalarsolver.h"
+
+#include "kernels.h"
+#include "profiler.h"
+
+const char *precision_name(Precision precision)
+{
+    switch (precision)
+    {
+    case Precision::Double:
+        return "double";
+    case Precision::Single:
+        return "float";
+    case Precision::Mixed:
+        return "mixed";
+    default:
+        return "";
+    }
+}
+
+// The explicit kernel matching the (Real, Accum) pair
+static void stencil(const double *in, double *out, std::size_t n, double alpha)
+{
+    explicit_step(in, out, n, alpha);
+}
+
+static void stencil(const float *in, float *out, std::size_t n, float alpha)
+{
+    explicit_step(in, out, n, alpha);
+}
+
+static void stencil(const float *in, float *out, std::size_t n, double alpha)
+{
+    explicit_step_mixed(in, out, n, alpha);
+}
+
+template <typename Real, typename Accum>
+ScalarSolver<Real, Accum>::ScalarSolver(const Parameters &param, MethodType method)
+    : param_(param), method_(method), off_(0), t_cur_(0.0), step_(0)
+{
+    const std::size_t n = param_.get_nx();
+    state_.resize(n);
+    tmp_state_.resize(n);
+    if (method_ == MethodType::Explicit)
+        return;
+
+    // Factorized in double and rounded once, like the state
+    const double alpha = param_.get_alpha();
+    const double off = (method_ == MethodType::Implicit) ? alpha : 0.5*alpha;
+    const double diag = (method_ == MethodType::Implicit) ? 2.0*alpha+1 : alpha+1;
+    off_ = static_cast<Accum>(off);
+    inv_denominator_.assign(n-1, Accum(0));
+    sweep_.resize(n);
+
+    double u = 0.0;
+    for (std::size_t i = 1; i < n-1; ++i)
+    {
+        const double inv_denominator = 1.0 / (off * u - diag);
+        inv_denominator_[i] = static_cast<Accum>(inv_denominator);
+        u = -off * inv_denominator;
+    }
+}
+
+template <typename Real, typename Accum>
+void ScalarSolver<Real, Accum>::init(InitialProfile profile)
+{
+    const double ampl = amplitude(profile, param_.get_dx());
+
+    for (std::size_t i = 0; i < state_.size(); ++i)
+        state_[i] = static_cast<Real>(initial((double(i) - state_.size()/2) * param_.get_dx(), profile, ampl));
+    tmp_state_ = state_;
+
+    t_cur_ = 0.0;
+    step_ = 0;
+}
+
+template <typename Real, typename Accum>
+void ScalarSolver<Real, Accum>::step()
+{
+    advance(1);
+}
+
+template <typename Real, typename Accum>
+void ScalarSolver<Real, Accum>::advance(std::int64_t steps)
+{
+    HEAT_PROFILE(Phase::Step, steps, steps * state_.size());
+
+    const std::size_t n = state_.size();
+    const Accum alpha = static_cast<Accum>(param_.get_alpha());
+    const Accum half_alpha = static_cast<Accum>(0.5 * param_.get_alpha());
+    const bool crank_nicolson = (method_ == MethodType::CrankNicolson);
+
+    for (std::int64_t k = 0; k < steps; ++k)
+    {
+        const Real *s = state_.data();
+        Real *out = tmp_state_.data();
+
+        if (method_ == MethodType::Explicit)
+        {
+            // Boundary nodes never change and both buffers are seeded with them in init()
+            stencil(s, out, n, alpha);
+        }
+        else
+        {
+            Accum *v = sweep_.data();
+            const Accum *inv_denominator = inv_denominator_.data();
+            {
+                HEAT_PROFILE(Phase::TdmaForward, 0, n);
+                v[0] = s[0];
+                if (crank_nicolson)
+                    for (std::size_t i = 1; i < n-1; ++i)
+                    {
+                        const Accum c = s[i];
+                        const Accum rhs = c + half_alpha*(Accum(s[i+1]) - Accum(2)*c + Accum(s[i-1]));
+                        v[i] = (-rhs - off_ * v[i-1]) * inv_denominator[i];
+                    }
+                else
+                    for (std::size_t i = 1; i < n-1; ++i)
+                        v[i] = (-Accum(s[i]) - off_ * v[i-1]) * inv_denominator[i];
+            }
+            HEAT_PROFILE(Phase::TdmaBackward, 0, n);
+            Accum x = s[n-1];
+            out[n-1] = s[n-1];
+            for (std::size_t i = n-2; i > 0; --i)
+            {
+                x = (-off_ * inv_denominator[i]) * x + v[i];
+                out[i] = static_cast<Real>(x);
+            }
+            out[0] = s[0];
+        }
+
+        state_.swap(tmp_state_);
+        t_cur_ += param_.get_dt();
+    }
+    step_ += steps;
+}
+
+template <typename Real, typename Accum>
+const Parameters &ScalarSolver<Real, Accum>::get_parameters() const
+{
+    return param_;
+}
+
+template <typename Real, typename Accum>
+MethodType ScalarSolver<Real, Accum>::get_method() const
+{
+    return method_;
+}
+
+template <typename Real, typename Accum>
+const typename ScalarSolver<Real, Accum>::State &ScalarSolver<Real, Accum>::get_state() const
+{
+    return state_;
+}
+
+template <typename Real, typename Accum>
+double ScalarSolver<Real, Accum>::get_t() const
+{
+    return t_cur_;
+}
+
+template <typename Real, typename Accum>
+std::int64_t ScalarSolver<Real, Accum>::get_step() const
+{
+    return step_;
+}
+
+template class ScalarSolver<double>;
+template class ScalarSolver<float>;
+template class ScalarSolver<float, double>;
@@ -0,0 +1,57 @@
+#ifndef SCALARSOLVER_H
+#define SCALARSOLVER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "aligned.h"
+#include "heat.h"
+#include "parameters.h"
+
+// Storage and arithmetic of a ScalarSolver run: double throughout, float
+// throughout, or float state with the stencil and the Thomas recurrences
+// evaluated in double
+enum class Precision {Double, Single, Mixed};
+
+const char *precision_name(Precision precision);
+
+// The fixed-step Explicit, Implicit and Crank-Nicolson schemes with fixed
+// ends on a state of Real values, for parameter scans where single precision
+// is accurate enough: a float state halves the memory traffic and doubles the
+// nodes per SIMD register. Accum is the type the explicit stencil, the
+// right-hand side and both Thomas sweeps are evaluated in; the forward sweep
+// keeps its intermediate values in Accum, so only the state is rounded to
+// Real once per step. ScalarSolver<double> repeats Solver's serial kernels.
+template <typename Real, typename Accum = Real>
+class ScalarSolver
+{
+public:
+    typedef std::vector<Real, AlignedAllocator<Real>> State;
+
+    ScalarSolver(const Parameters &param, MethodType method);
+
+    void init(InitialProfile profile);
+    void step();
+    void advance(std::int64_t steps);
+
+    const Parameters &get_parameters() const;
+    MethodType get_method() const;
+    const State &get_state() const;
+    double get_t() const;
+    std::int64_t get_step() const;
+
+private:
+    Parameters param_;
+    MethodType method_;
+    State state_, tmp_state_;
+    // Thomas coefficients as in Tridiagonal, u[i] = -off*inv_denominator_[i]
+    Accum off_;
+    std::vector<Accum, AlignedAllocator<Accum>> inv_denominator_, sweep_;
+    double t_cur_;
+    std::int64_t step_;
+};
+
+typedef ScalarSolver<float> FloatSolver;
+typedef ScalarSolver<float, double> MixedSolver;
+
+#endif // SCALARSOLVER_H
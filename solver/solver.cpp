@@ -0,0 +1,706 @@
+#include "solver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "compiler.h"
+#include "kernels.h"
+#include "profiler.h"
+
+Solver::Solver(const Parameters &param, MethodType method)
+    : param_(param), method_(method), t_cur_(0.0), step_(0), monitor_every_(0), peak_(0.0), initial_peak_(0.0),
+      tile_(kExplicitTile), depth_(kExplicitDepth),
+      boundary_(BoundaryType::Dirichlet), robin_(0.0), variable_(false), nonlinear_mode_(NonlinearMode::Lagged), max_iterations_(1), iterations_(0), tolerance_(0.0)
+{
+    state_.resize(param_.get_nx());
+    tmp_state_.resize(state_.size());
+
+    const double alpha = param_.get_alpha();
+    switch (method_)
+    {
+    case MethodType::Explicit:
+        break;
+    case MethodType::Implicit:
+        tdma_ = Tridiagonal(state_.size(), alpha, 2.0*alpha+1);
+        break;
+    case MethodType::CrankNicolson:
+        tdma_ = Tridiagonal(state_.size(), 0.5*alpha, alpha+1);
+        break;
+    }
+}
+
+void Solver::init(InitialProfile profile)
+{
+    double ampl = amplitude(profile, param_.get_dx());
+
+    for (decltype(state_.size()) i = 0; i < state_.size(); ++i)
+        state_[i] = initial((double(i) - state_.size()/2) * param_.get_dx(), profile, ampl);
+    if (boundary_ == BoundaryType::Periodic)
+        state_.back() = state_.front();
+    tmp_state_ = state_;
+
+    t_cur_ = 0.0;
+    step_ = 0;
+    peak_ = initial_peak_ = max_abs(state_.data(), state_.size());
+}
+
+void Solver::resume(const double *state, double t, std::int64_t step, double initial_peak)
+{
+    std::copy(state, state + state_.size(), state_.begin());
+    tmp_state_ = state_;
+
+    t_cur_ = t;
+    step_ = step;
+    peak_ = max_abs(state_.data(), state_.size());
+    initial_peak_ = initial_peak;
+}
+
+void Solver::step()
+{
+    advance(1);
+}
+
+void Solver::advance(std::int64_t steps)
+{
+    HEAT_PROFILE(Phase::Step, steps, steps * state_.size());
+
+    const std::int64_t first = step_;
+    step_ += steps;
+    if (variable_)
+    {
+        for (std::int64_t k = 1; k <= steps; ++k)
+        {
+            step_variable();
+            if (monitor_every_ > 0 && (first + k) % monitor_every_ == 0)
+                peak_ = max_abs(state_.data(), state_.size());
+        }
+        return;
+    }
+
+    switch (method_)
+    {
+    case MethodType::Explicit:
+        advance_method<MethodType::Explicit>(steps);
+        break;
+    case MethodType::Implicit:
+        advance_method<MethodType::Implicit>(steps);
+        break;
+    case MethodType::CrankNicolson:
+        advance_method<MethodType::CrankNicolson>(steps);
+        break;
+    }
+}
+
+template <MethodType M>
+void Solver::advance_method(std::int64_t steps)
+{
+    switch (boundary_)
+    {
+    case BoundaryType::Dirichlet:
+        advance_with<M, BoundaryType::Dirichlet>(steps);
+        break;
+    case BoundaryType::Neumann:
+        advance_with<M, BoundaryType::Neumann>(steps);
+        break;
+    case BoundaryType::Periodic:
+        advance_with<M, BoundaryType::Periodic>(steps);
+        break;
+    case BoundaryType::Robin:
+        advance_with<M, BoundaryType::Robin>(steps);
+        break;
+    }
+}
+
+template <MethodType M, BoundaryType B>
+void Solver::advance_with(std::int64_t steps)
+{
+    if (monitor_every_ < 1)
+    {
+        advance_bulk<M, B>(steps);
+        return;
+    }
+
+    // Unmonitored runs up to every monitor_every_-th step
+    std::int64_t done = step_ - steps;
+    while (steps > 0)
+    {
+        const std::int64_t bulk = std::min(steps, monitor_every_ - 1 - done % monitor_every_);
+        if (bulk > 0)
+            advance_bulk<M, B>(bulk);
+        done += bulk;
+        steps -= bulk;
+        if (steps > 0)
+        {
+            step_monitored<M, B>();
+            ++done;
+            --steps;
+        }
+    }
+}
+
+template <MethodType M, BoundaryType B>
+void Solver::advance_bulk(std::int64_t steps)
+{
+    if (B != BoundaryType::Dirichlet)
+    {
+        for (std::int64_t k = 0; k < steps; ++k)
+            step_with<M, B>();
+        return;
+    }
+
+    if (M == MethodType::Explicit)
+    {
+        if (pool_)
+            advance_explicit_parallel(steps);
+        else if (depth_ > 1 && state_.size() > 2*tile_)
+            advance_explicit_blocked(steps);
+        else
+            for (std::int64_t k = 0; k < steps; ++k)
+                step_explicit();
+    }
+    else if (pool_)
+        advance_implicit_parallel(steps);
+    else if (M == MethodType::Implicit)
+        for (std::int64_t k = 0; k < steps; ++k)
+            step_implicit();
+    else
+        for (std::int64_t k = 0; k < steps; ++k)
+            step_crank_nicolson();
+}
+
+void Solver::set_temporal_blocking(std::size_t tile, int depth)
+{
+    tile_ = std::max(tile, std::size_t(1));
+    depth_ = depth;
+}
+
+void Solver::set_threads(int threads)
+{
+    if (threads > 1)
+        pool_.reset(new ThreadPool(threads));
+    else
+        pool_.reset();
+
+    if (pool_ && method_ != MethodType::Explicit)
+        partitioned_tdma_ = PartitionedTridiagonal(state_.size(), tdma_.get_off(), tdma_.get_diag(), threads);
+    else
+        partitioned_tdma_ = PartitionedTridiagonal();
+}
+
+int Solver::get_threads() const
+{
+    return pool_ ? pool_->size() : 1;
+}
+
+void Solver::set_boundary(BoundaryType type, double robin)
+{
+    if (variable_ && type != BoundaryType::Dirichlet)
+        throw std::logic_error("conductivity runs keep Dirichlet ends");
+
+    boundary_ = type;
+    robin_ = (type == BoundaryType::Robin) ? robin : 0.0;
+
+    const std::size_t n = state_.size();
+    const double alpha = param_.get_alpha();
+    const double theta = this->theta();
+    general_tdma_ = GeneralTridiagonal();
+    cyclic_tdma_ = CyclicTridiagonal();
+    // The last node duplicates the first on a ring, every method steps from it
+    if (boundary_ == BoundaryType::Periodic)
+        state_[n-1] = tmp_state_[n-1] = state_[0];
+    if (method_ == MethodType::Explicit)
+        return;
+
+    if (boundary_ == BoundaryType::Periodic)
+        cyclic_tdma_ = CyclicTridiagonal(n-1, theta*alpha, 1.0 + 2.0*theta*alpha);
+    else if (boundary_ != BoundaryType::Dirichlet)
+    {
+        // End rows use the ghost node u[-1] = u[1] - 2*dx*beta*u[0]
+        const double c = theta*alpha, end = 1.0 + 2.0*c*(1.0 + robin_*param_.get_dx());
+        std::vector<double> lower(n, -c), diag(n, 1.0 + 2.0*c), upper(n, -c);
+        diag[0] = diag[n-1] = end;
+        upper[0] = lower[n-1] = -2.0*c;
+        general_tdma_ = GeneralTridiagonal(lower, diag, upper);
+    }
+}
+
+BoundaryType Solver::get_boundary() const
+{
+    return boundary_;
+}
+
+double Solver::get_robin() const
+{
+    return robin_;
+}
+
+void Solver::set_conductivity(const std::vector<double> &k)
+{
+    if (k.size() != state_.size())
+        throw std::invalid_argument("conductivity needs one value per node");
+
+    if (boundary_ != BoundaryType::Dirichlet)
+        throw std::logic_error("conductivity runs keep Dirichlet ends");
+
+    variable_ = true;
+    conductivity_ = k;
+    conductivity_function_ = nullptr;
+    max_iterations_ = 1;
+
+    variable_tdma_ = VariableTridiagonal(state_.size());
+    update_faces(nullptr);
+}
+
+void Solver::set_conductivity(const std::function<double(double, double)> &k, NonlinearMode mode,
+                              int max_iterations, double tolerance)
+{
+    if (boundary_ != BoundaryType::Dirichlet)
+        throw std::logic_error("conductivity runs keep Dirichlet ends");
+
+    variable_ = true;
+    conductivity_.assign(state_.size(), 1.0);
+    conductivity_function_ = k;
+    nonlinear_mode_ = mode;
+    max_iterations_ = (mode == NonlinearMode::Picard && method_ != MethodType::Explicit) ? std::max(max_iterations, 1) : 1;
+    tolerance_ = tolerance;
+
+    variable_tdma_ = VariableTridiagonal(state_.size());
+}
+
+void Solver::clear_conductivity()
+{
+    variable_ = false;
+    conductivity_.clear();
+    conductivity_function_ = nullptr;
+}
+
+ConductivityType Solver::get_conductivity_type() const
+{
+    if (!variable_)
+        return ConductivityType::None;
+    return conductivity_function_ ? ConductivityType::Function : ConductivityType::Field;
+}
+
+const std::vector<double> &Solver::get_conductivity() const
+{
+    return conductivity_;
+}
+
+NonlinearMode Solver::get_nonlinear_mode() const
+{
+    return nonlinear_mode_;
+}
+
+int Solver::get_iterations() const
+{
+    return iterations_;
+}
+
+const Parameters &Solver::get_parameters() const
+{
+    return param_;
+}
+
+MethodType Solver::get_method() const
+{
+    return method_;
+}
+
+const AlignedVector &Solver::get_state() const
+{
+    return state_;
+}
+
+double Solver::get_t() const
+{
+    return t_cur_;
+}
+
+std::int64_t Solver::get_step() const
+{
+    return step_;
+}
+
+void Solver::set_monitor(std::int64_t every)
+{
+    monitor_every_ = std::max<std::int64_t>(every, 0);
+}
+
+std::int64_t Solver::get_monitor() const
+{
+    return monitor_every_;
+}
+
+double Solver::get_peak() const
+{
+    return peak_;
+}
+
+double Solver::get_initial_peak() const
+{
+    return initial_peak_;
+}
+
+bool Solver::has_diverged() const
+{
+    return peak_ > kDivergenceFactor * initial_peak_;
+}
+
+void Solver::step_explicit()
+{
+    const double alpha = param_.get_alpha();
+
+    // Boundary nodes never change and both buffers are seeded with them in init()
+    explicit_step(state_.data(), tmp_state_.data(), state_.size(), alpha);
+
+    state_.swap(tmp_state_);
+    t_cur_ += param_.get_dt();
+}
+
+void Solver::advance_explicit_blocked(std::int64_t steps)
+{
+    const double alpha = param_.get_alpha();
+
+    scratch_.resize(explicit_tiled_scratch_size(tile_, depth_));
+    while (steps > 0)
+    {
+        int k = static_cast<int>(std::min<std::int64_t>(steps, depth_));
+        explicit_step_tiled(state_.data(), tmp_state_.data(), state_.size(), alpha, k, tile_, scratch_.data());
+        state_.swap(tmp_state_);
+
+        for (int s = 0; s < k; ++s)
+            t_cur_ += param_.get_dt();
+        steps -= k;
+    }
+}
+
+void Solver::advance_explicit_parallel(std::int64_t steps)
+{
+    const double alpha = param_.get_alpha();
+    const std::size_t n = state_.size();
+    const int threads = pool_->size();
+    const bool blocked = depth_ > 1;
+    const int depth = blocked ? depth_ : 1;
+    const std::size_t scratch_size = explicit_tiled_scratch_size(tile_, depth);
+    if (blocked)
+        scratch_.resize(scratch_size * threads);
+
+    std::int64_t rounds = (steps + depth - 1) / depth;
+    pool_->run([&](int index)
+    {
+        // Chunk borders on cache-line (8 doubles) boundaries to avoid false sharing
+        const std::size_t first = std::max(((n-2) * index / threads) & ~std::size_t(7), std::size_t(1));
+        const std::size_t last = (index+1 == threads) ? n-1 : std::max(((n-2) * (index+1) / threads) & ~std::size_t(7), std::size_t(1));
+
+        double *in = state_.data();
+        double *out = tmp_state_.data();
+        for (std::int64_t remaining = steps; remaining > 0; remaining -= depth)
+        {
+            int k = static_cast<int>(std::min<std::int64_t>(remaining, depth));
+            if (first < last)
+            {
+                if (blocked)
+                    explicit_step_tiled(in, out, n, alpha, k, tile_, scratch_.data() + scratch_size*index, first, last);
+                else
+                    explicit_step(in + first - 1, out + first - 1, last - first + 2, alpha);
+            }
+            pool_->barrier();
+            std::swap(in, out);
+        }
+    });
+
+    if (rounds % 2 == 1)
+        state_.swap(tmp_state_);
+    for (std::int64_t s = 0; s < steps; ++s)
+        t_cur_ += param_.get_dt();
+}
+
+void Solver::advance_implicit_parallel(std::int64_t steps)
+{
+    const double half_alpha = 0.5 * param_.get_alpha();
+    const bool crank_nicolson = (method_ == MethodType::CrankNicolson);
+    const std::size_t n = state_.size();
+    const int parts = partitioned_tdma_.parts();
+
+    pool_->run([&](int index)
+    {
+        double *in = state_.data();
+        double *out = tmp_state_.data();
+        for (std::int64_t k = 0; k < steps; ++k)
+        {
+            const double *s = in;
+            auto implicit_rhs = [s](std::size_t i) { return s[i]; };
+            auto crank_nicolson_rhs = [s, half_alpha](std::size_t i) { return s[i] + half_alpha*(s[i+1]-2.0*s[i]+s[i-1]); };
+
+            if (index < parts)
+            {
+                if (crank_nicolson)
+                    partitioned_tdma_.solve_part(index, crank_nicolson_rhs, out);
+                else
+                    partitioned_tdma_.solve_part(index, implicit_rhs, out);
+            }
+            pool_->barrier();
+
+            if (index == 0)
+            {
+                if (crank_nicolson)
+                    partitioned_tdma_.solve_interface([&](std::size_t i) { return (i == 0 || i == n-1) ? s[i] : crank_nicolson_rhs(i); }, out);
+                else
+                    partitioned_tdma_.solve_interface(implicit_rhs, out);
+            }
+            pool_->barrier();
+
+            if (index < parts)
+                partitioned_tdma_.correct_part(index, out);
+            pool_->barrier();
+
+            std::swap(in, out);
+        }
+    });
+
+    if (steps % 2 == 1)
+        state_.swap(tmp_state_);
+    for (std::int64_t s = 0; s < steps; ++s)
+        t_cur_ += param_.get_dt();
+}
+
+HEAT_NO_CONTRACT
+void Solver::step_implicit()
+{
+    const double *s = state_.data();
+    {
+        HEAT_PROFILE(Phase::TdmaForward, 0, state_.size());
+        tdma_.forward(s[0], [s](std::size_t i) { return s[i]; }, tmp_state_.data());
+    }
+    {
+        HEAT_PROFILE(Phase::TdmaBackward, 0, state_.size());
+        tdma_.backward(tmp_state_.data(), s[state_.size()-1], tmp_state_.data());
+    }
+
+    state_.swap(tmp_state_);
+    t_cur_ += param_.get_dt();
+}
+
+HEAT_NO_CONTRACT
+void Solver::step_crank_nicolson()
+{
+    const double half_alpha = 0.5 * param_.get_alpha();
+    const double *s = state_.data();
+
+    {
+        HEAT_PROFILE(Phase::TdmaForward, 0, state_.size());
+        tdma_.forward(s[0], [s, half_alpha](std::size_t i) { return s[i] + half_alpha*(s[i+1]-2.0*s[i]+s[i-1]); }, tmp_state_.data());
+    }
+    {
+        HEAT_PROFILE(Phase::TdmaBackward, 0, state_.size());
+        tdma_.backward(tmp_state_.data(), state_.back(), tmp_state_.data());
+    }
+
+    state_.swap(tmp_state_);
+    t_cur_ += param_.get_dt();
+}
+
+// Same updates as advance_bulk(1), with the peak taken inside the kernel that
+// writes the new state
+template <MethodType M, BoundaryType B>
+HEAT_NO_CONTRACT
+void Solver::step_monitored()
+{
+    const std::size_t n = state_.size();
+    const double *s = state_.data();
+    double *out = tmp_state_.data();
+
+    if (B != BoundaryType::Dirichlet)
+    {
+        step_with<M, B, true>();
+        return;
+    }
+
+    if (M == MethodType::Explicit)
+    {
+        // Serial, blocked and threaded explicit kernels agree bit for bit
+        peak_ = std::max(explicit_step_peak(s, out, n, param_.get_alpha()), std::max(max_abs(s, 1), max_abs(s + n-1, 1)));
+    }
+    else if (pool_)
+    {
+        // The partitioned solve has no single sweep to carry the maximum
+        advance_bulk<M, B>(1);
+        peak_ = max_abs(state_.data(), n);
+        return;
+    }
+    else
+    {
+        const double half_alpha = 0.5 * param_.get_alpha();
+        {
+            HEAT_PROFILE(Phase::TdmaForward, 0, n);
+            if (M == MethodType::CrankNicolson)
+                tdma_.forward(s[0], [s, half_alpha](std::size_t i) { return s[i] + half_alpha*(s[i+1]-2.0*s[i]+s[i-1]); }, out);
+            else
+                tdma_.forward(s[0], [s](std::size_t i) { return s[i]; }, out);
+        }
+        HEAT_PROFILE(Phase::TdmaBackward, 0, n);
+        peak_ = tdma_.backward_peak(out, s[n-1], out);
+    }
+
+    state_.swap(tmp_state_);
+    t_cur_ += param_.get_dt();
+}
+
+template <MethodType M, BoundaryType B, bool Monitored>
+void Solver::step_with()
+{
+    const std::size_t n = state_.size();
+    const double alpha = param_.get_alpha();
+    const double *s = state_.data();
+    double *out = tmp_state_.data();
+    // The second difference at an end node through the ghost node
+    // u[-1] = u[1] - 2*dx*beta*u[0] is 2*(u[1] - (1 + dx*beta)*u[0])
+    const double loss = 1.0 + ((B == BoundaryType::Robin) ? robin_ * param_.get_dx() : 0.0);
+
+    if (M == MethodType::Explicit)
+    {
+        if (Monitored)
+            peak_ = explicit_step_peak(s, out, n, alpha);
+        else
+            explicit_step(s, out, n, alpha);
+        if (B == BoundaryType::Periodic)
+        {
+            out[0] = out[n-1] = s[0] + alpha*(s[1] - 2.0*s[0] + s[n-2]);
+        }
+        else
+        {
+            out[0] = s[0] + 2.0*alpha*(s[1] - loss*s[0]);
+            out[n-1] = s[n-1] + 2.0*alpha*(s[n-2] - loss*s[n-1]);
+        }
+        if (Monitored)
+            peak_ = std::max(peak_, std::max(max_abs(out, 1), max_abs(out + n-1, 1)));
+    }
+    else if (B == BoundaryType::Periodic)
+    {
+        // Unknowns 0..n-2 on the ring, s[n-1] duplicates s[0]
+        const std::size_t m = n-1;
+        const double half_alpha = 0.5*alpha;
+        if (M == MethodType::CrankNicolson)
+            cyclic_tdma_.solve([s, m, half_alpha](std::size_t i) { return s[i] + half_alpha*(s[i+1] - 2.0*s[i] + s[i ? i-1 : m-1]); }, out);
+        else
+            cyclic_tdma_.solve([s](std::size_t i) { return s[i]; }, out);
+        out[n-1] = out[0];
+    }
+    else
+    {
+        const double half_alpha = 0.5*alpha;
+        {
+            HEAT_PROFILE(Phase::TdmaForward, 0, n);
+            if (M == MethodType::CrankNicolson)
+                general_tdma_.forward([s, n, half_alpha, loss](std::size_t i)
+                {
+                    if (i == 0)
+                        return s[0] + 2.0*half_alpha*(s[1] - loss*s[0]);
+                    if (i == n-1)
+                        return s[n-1] + 2.0*half_alpha*(s[n-2] - loss*s[n-1]);
+                    return s[i] + half_alpha*(s[i+1] - 2.0*s[i] + s[i-1]);
+                }, out);
+            else
+                general_tdma_.forward([s](std::size_t i) { return s[i]; }, out);
+        }
+        HEAT_PROFILE(Phase::TdmaBackward, 0, n);
+        general_tdma_.backward(out);
+    }
+    if (Monitored && M != MethodType::Explicit)
+        peak_ = max_abs(out, n);
+
+    state_.swap(tmp_state_);
+    t_cur_ += param_.get_dt();
+}
+
+double Solver::theta() const
+{
+    switch (method_)
+    {
+    case MethodType::Explicit:
+        return 0.0;
+    case MethodType::Implicit:
+        return 1.0;
+    case MethodType::CrankNicolson:
+        return 0.5;
+    }
+    return 0.0;
+}
+
+void Solver::update_faces(const double *u)
+{
+    const std::size_t n = state_.size();
+    const double alpha = param_.get_alpha();
+
+    if (conductivity_function_)
+        for (std::size_t i = 0; i < n; ++i)
+            conductivity_[i] = conductivity_function_((double(i) - n/2) * param_.get_dx(), u[i]);
+
+    face_.resize(n);
+    face_[0] = 0.0;
+    for (std::size_t i = 1; i < n; ++i)
+        face_[i] = alpha * 0.5 * (conductivity_[i-1] + conductivity_[i]);
+
+    if (method_ != MethodType::Explicit)
+        variable_tdma_.factorize(face_.data(), theta());
+}
+
+// theta-scheme on the flux form u_t = (k u_x)_x:
+//     u' - theta*L(u') = u + (1-theta)*L(u),  L(u)_i = f[i+1]*(u[i+1]-u[i]) - f[i]*(u[i]-u[i-1])
+void Solver::step_variable()
+{
+    const std::size_t n = state_.size();
+    const double *s = state_.data();
+    double *out = tmp_state_.data();
+
+    if (conductivity_function_)
+        update_faces(s);
+
+    const double *f = face_.data();
+    const double w = 1.0 - theta();
+    auto rhs = [s, f, w](std::size_t i) { return s[i] + w*(f[i+1]*(s[i+1]-s[i]) - f[i]*(s[i]-s[i-1])); };
+
+    iterations_ = 1;
+    if (method_ == MethodType::Explicit)
+    {
+        for (std::size_t i = 1; i < n-1; ++i)
+            out[i] = rhs(i);
+    }
+    else
+    {
+        variable_tdma_.forward(s[0], rhs, out);
+        variable_tdma_.backward(out, s[n-1], out);
+    }
+
+    if (iterations_ < max_iterations_)
+    {
+        // The explicit part keeps the conductivity of the old state, only the
+        // implicit part follows the iterate
+        rhs_.resize(n);
+        for (std::size_t i = 1; i < n-1; ++i)
+            rhs_[i] = rhs(i);
+        const double *r = rhs_.data();
+
+        while (iterations_ < max_iterations_)
+        {
+            iterate_.assign(out, out + n);
+            update_faces(iterate_.data());
+            variable_tdma_.forward(s[0], [r](std::size_t i) { return r[i]; }, out);
+            variable_tdma_.backward(out, s[n-1], out);
+            ++iterations_;
+
+            double change = 0.0, norm = 0.0;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                change = std::max(change, std::abs(out[i] - iterate_[i]));
+                norm = std::max(norm, std::abs(out[i]));
+            }
+            if (change <= tolerance_ * norm)
+                break;
+        }
+    }
+
+    state_.swap(tmp_state_);
+    t_cur_ += param_.get_dt();
+}
@@ -0,0 +1,146 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "aligned.h"
+#include "heat.h"
+#include "parameters.h"
+#include "threadpool.h"
+#include "tridiagonal.h"
+
+// Default temporal tiling of the explicit scheme: tiles of kExplicitTile nodes
+// advanced kExplicitDepth steps at a time (about 130 KB of scratch, L2 resident)
+constexpr std::size_t kExplicitTile = 8192;
+constexpr int kExplicitDepth = 32;
+// The heat equation never rises above its initial maximum: a peak beyond this
+// factor times the starting one means the scheme blew up
+constexpr double kDivergenceFactor = 3.0;
+
+// How a temperature-dependent conductivity enters the implicit schemes: taken
+// from the state at the start of the step, or iterated to convergence
+enum class NonlinearMode {Lagged, Picard};
+// Which set_conductivity() a solver was set up with
+enum class ConductivityType {None, Field, Function};
+
+class Solver
+{
+public:
+    Solver(const Parameters &param, MethodType method);
+
+    void init(InitialProfile profile);
+    // Continues a run from a saved state; the solver must be configured as the
+    // one the state was taken from (see checkpoint.h). initial_peak is
+    // get_initial_peak() of that run, the divergence baseline.
+    void resume(const double *state, double t, std::int64_t step, double initial_peak);
+    void step();
+    void advance(std::int64_t steps);
+
+    // depth <= 1 disables temporal blocking
+    void set_temporal_blocking(std::size_t tile, int depth);
+    // Splits every scheme over a persistent pool of threads: the explicit one by
+    // domain decomposition, the implicit ones with a partitioned Thomas solve
+    void set_threads(int threads);
+    int get_threads() const;
+
+    // Dirichlet ends keep the SIMD, blocked and threaded kernels; the other
+    // conditions run serially. robin is beta of the Robin condition. A
+    // periodic rod identifies its two end nodes.
+    void set_boundary(BoundaryType type, double robin = 0.0);
+    BoundaryType get_boundary() const;
+    double get_robin() const;
+
+    // Conductivity k multiplying alpha node by node; the flux between two nodes
+    // uses the mean of their k. A field is factorized once, a function k(x, u)
+    // is re-evaluated every step. Picard mode re-solves the implicit part with
+    // k from the latest iterate until the update drops below tolerance times
+    // the largest value. Without a conductivity the constant-alpha kernels run
+    // unchanged; with one, every scheme runs serially on the flux form.
+    void set_conductivity(const std::vector<double> &k);
+    void set_conductivity(const std::function<double(double, double)> &k, NonlinearMode mode,
+                          int max_iterations = 20, double tolerance = 1e-10);
+    void clear_conductivity();
+    ConductivityType get_conductivity_type() const;
+    // The field of set_conductivity(k); with a function, its values at the
+    // latest step
+    const std::vector<double> &get_conductivity() const;
+    NonlinearMode get_nonlinear_mode() const;
+    // Picard iterations taken by the last step
+    int get_iterations() const;
+
+    const Parameters &get_parameters() const;
+    MethodType get_method() const;
+    const AlignedVector &get_state() const;
+    double get_t() const;
+    // Steps taken since init()
+    std::int64_t get_step() const;
+
+    // Divergence monitor: every `every`-th step (0 disables it) also finds the
+    // largest |u| of the new state inside its update kernel; the steps in
+    // between run the unmonitored kernels. get_peak() is that value at the
+    // latest monitored step, init() or resume(), +inf once the state is no
+    // longer finite. Boundary rows are outside is_stable(), this catches them.
+    void set_monitor(std::int64_t every);
+    std::int64_t get_monitor() const;
+    double get_peak() const;
+    // Largest |u| at init(), carried over by resume()
+    double get_initial_peak() const;
+    bool has_diverged() const;
+
+private:
+    Parameters param_;
+    MethodType method_;
+    AlignedVector state_, tmp_state_;
+    Tridiagonal tdma_;
+    PartitionedTridiagonal partitioned_tdma_;
+    double t_cur_;
+    std::int64_t step_;
+    std::int64_t monitor_every_;
+    double peak_, initial_peak_;
+
+    std::size_t tile_;
+    int depth_;
+    AlignedVector scratch_;
+    std::unique_ptr<ThreadPool> pool_;
+
+    BoundaryType boundary_;
+    double robin_;
+    GeneralTridiagonal general_tdma_;
+    CyclicTridiagonal cyclic_tdma_;
+
+    bool variable_;
+    std::vector<double> conductivity_;
+    std::function<double(double, double)> conductivity_function_;
+    NonlinearMode nonlinear_mode_;
+    int max_iterations_, iterations_;
+    double tolerance_;
+    AlignedVector face_, rhs_, iterate_;
+    VariableTridiagonal variable_tdma_;
+
+    // advance() dispatches once per call onto the kernel compiled for the
+    // (method, boundary) pair, no per-step branching remains inside
+    template <MethodType M>
+    void advance_method(std::int64_t steps);
+    template <MethodType M, BoundaryType B>
+    void advance_with(std::int64_t steps);
+    template <MethodType M, BoundaryType B>
+    void advance_bulk(std::int64_t steps);
+    template <MethodType M, BoundaryType B>
+    void step_monitored();
+    template <MethodType M, BoundaryType B, bool Monitored = false>
+    void step_with();
+
+    void step_explicit();
+    void advance_explicit_blocked(std::int64_t steps);
+    void advance_explicit_parallel(std::int64_t steps);
+    void advance_implicit_parallel(std::int64_t steps);
+    void step_implicit();
+    void step_crank_nicolson();
+    double theta() const;
+    void update_faces(const double *u);
+    void step_variable();
+};
+
+#endif // SOLVER_H
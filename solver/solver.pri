@@ -0,0 +1,47 @@
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SOURCES += \
+    $$PWD/adaptivesolver.cpp \
+    $$PWD/adisolver.cpp \
+    $$PWD/batchsolver.cpp \
+    $$PWD/checkpoint.cpp \
+    $$PWD/exactcache.cpp \
+    $$PWD/fft.cpp \
+    $$PWD/framefile.cpp \
+    $$PWD/gridsolver.cpp \
+    $$PWD/heat.cpp \
+    $$PWD/kernels.cpp \
+    $$PWD/multigrid.cpp \
+    $$PWD/parameters.cpp \
+    $$PWD/profiler.cpp \
+    $$PWD/scalarsolver.cpp \
+    $$PWD/solver.cpp \
+    $$PWD/solverworker.cpp \
+    $$PWD/spectral.cpp \
+    $$PWD/threadpool.cpp \
+    $$PWD/tridiagonal.cpp
+
+HEADERS += \
+    $$PWD/adaptivesolver.h \
+    $$PWD/adisolver.h \
+    $$PWD/aligned.h \
+    $$PWD/batchsolver.h \
+    $$PWD/checkpoint.h \
+    $$PWD/compiler.h \
+    $$PWD/exactcache.h \
+    $$PWD/fft.h \
+    $$PWD/framefile.h \
+    $$PWD/gridsolver.h \
+    $$PWD/heat.h \
+    $$PWD/kernels.h \
+    $$PWD/multigrid.h \
+    $$PWD/parameters.h \
+    $$PWD/profiler.h \
+    $$PWD/scalarsolver.h \
+    $$PWD/solver.h \
+    $$PWD/solverworker.h \
+    $$PWD/spectral.h \
+    $$PWD/spscring.h \
+    $$PWD/threadpool.h \
+    $$PWD/tridiagonal.h
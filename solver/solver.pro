@@ -0,0 +1,16 @@
+#-------------------------------------------------
+#
+# Headless solver engine: the numerical schemes of HeatEquation
+# without any dependency on QtGui/QtWidgets/QtCharts.
+#
+#-------------------------------------------------
+
+QT       -= gui
+
+TARGET = heatsolver
+TEMPLATE = lib
+CONFIG += staticlib
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(solver.pri)
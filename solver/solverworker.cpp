@@ -0,0 +1,139 @@
+#include "solverworker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+SolverWorker::SolverWorker(Solver &solver, std::size_t capacity)
+    : solver_(solver), ring_(capacity), stop_(false), running_(false), writer_(nullptr)
+{}
+
+SolverWorker::~SolverWorker()
+{
+    stop();
+}
+
+void SolverWorker::start(double t_end, double keyframe_interval, double frame_interval, AbortCheck abort)
+{
+    stop();
+
+    stop_ = false;
+    running_ = true;
+    thread_ = std::thread(&SolverWorker::run, this, t_end, keyframe_interval, frame_interval, abort);
+}
+
+void SolverWorker::stop()
+{
+    stop_ = true;
+    if (thread_.joinable())
+        thread_.join();
+    running_ = false;
+}
+
+bool SolverWorker::is_running() const
+{
+    return running_;
+}
+
+void SolverWorker::set_writer(FrameWriter *writer)
+{
+    writer_ = writer;
+}
+
+std::shared_ptr<const Snapshot> SolverWorker::poll()
+{
+    std::shared_ptr<const Snapshot> snapshot;
+    ring_.pop(snapshot);
+    return snapshot;
+}
+
+void SolverWorker::run(double t_end, double keyframe_interval, double frame_interval, AbortCheck abort)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const double dt = solver_.get_parameters().get_dt();
+    const std::chrono::duration<double> frame(frame_interval);
+
+    int keyframe = 1;
+    std::int64_t batch = 1;
+    Clock::time_point last_frame = Clock::now();
+    record();
+
+    while (!stop_ && solver_.get_t() < t_end + 1e-3*dt)
+    {
+        // Bulk steps up to just before the next keyframe, single steps across it
+        const double next_keyframe = keyframe_interval * keyframe;
+        const double steps_left = std::floor((std::min(next_keyframe, t_end) - solver_.get_t()) / dt) - 1;
+        std::int64_t steps = std::max<std::int64_t>(1, std::min<std::int64_t>(batch, static_cast<std::int64_t>(std::max(steps_left, 0.0))));
+        if (writer_)
+            steps = std::min(steps, writer_->get_every() - solver_.get_step() % writer_->get_every());
+
+        Clock::time_point start = Clock::now();
+        solver_.advance(steps);
+        record();
+        Clock::time_point finish = Clock::now();
+
+        // Aim for several batches per frame so frames are published on time
+        if (finish - start < frame / 4)
+            batch *= 2;
+        else if (finish - start > frame && batch > 1)
+            batch /= 2;
+
+        if (abort && abort(solver_.get_state()))
+        {
+            publish(true, true);
+            break;
+        }
+
+        if (solver_.get_t() > next_keyframe)
+        {
+            ++keyframe;
+            publish(true, false);
+        }
+        else if (finish - last_frame >= frame)
+        {
+            last_frame = finish;
+            publish(false, false);
+        }
+
+        if (solver_.get_t() >= t_end + 1e-3*dt)
+            publish(false, true);
+    }
+
+    running_ = false;
+}
+
+void SolverWorker::record()
+{
+    if (!writer_)
+        return;
+
+    // A failing writer is dropped; it raises the error again from close()
+    try
+    {
+        writer_->write(solver_.get_step(), solver_.get_state().data());
+    }
+    catch (const std::runtime_error &)
+    {
+        writer_ = nullptr;
+    }
+}
+
+void SolverWorker::publish(bool keyframe, bool last)
+{
+    std::shared_ptr<Snapshot> snapshot = std::make_shared<Snapshot>();
+    snapshot->step = solver_.get_step();
+    snapshot->t = solver_.get_t();
+    snapshot->keyframe = keyframe;
+    snapshot->last = last;
+    snapshot->state.assign(solver_.get_state().begin(), solver_.get_state().end());
+
+    if (!keyframe && !last)
+    {
+        ring_.push(snapshot);
+        return;
+    }
+
+    while (!ring_.push(snapshot) && !stop_)
+        std::this_thread::yield();
+}
@@ -0,0 +1,68 @@
+#ifndef SOLVERWORKER_H
+#define SOLVERWORKER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "framefile.h"
+#include "solver.h"
+#include "spscring.h"
+
+// Immutable copy of the solver state handed from the worker to the GUI
+struct Snapshot
+{
+    std::int64_t step;
+    double t;
+    bool keyframe;  // crossed one of the requested keyframe times, or aborted
+    bool last;      // final snapshot of the run
+    std::vector<double> state;
+};
+
+// Runs a Solver flat out on a dedicated thread and publishes snapshots through
+// a lock-free single-producer/single-consumer ring:
+//  - keyframes, on the first step past every multiple of keyframe_interval;
+//    they are never dropped, the worker waits for ring space instead,
+//  - frames, at most once per frame_interval of wall time; they are dropped
+//    when the consumer falls behind, so plotting never slows the solver down.
+// The solver must not be touched by other threads while the worker runs.
+class SolverWorker
+{
+public:
+    typedef std::function<bool(const AlignedVector &)> AbortCheck;
+
+    explicit SolverWorker(Solver &solver, std::size_t capacity = 64);
+    ~SolverWorker();
+
+    SolverWorker(const SolverWorker &) = delete;
+    SolverWorker &operator=(const SolverWorker &) = delete;
+
+    // Runs while t < t_end (up to 1e-3*dt of rounding); abort is checked after
+    // every batch of steps and ends the run with a keyframe
+    void start(double t_end, double keyframe_interval, double frame_interval, AbortCheck abort = AbortCheck());
+    void stop();
+    bool is_running() const;
+
+    // Frames of the next run are also streamed to writer (nullptr: none);
+    // batches then stop on every multiple of its frame interval
+    void set_writer(FrameWriter *writer);
+
+    // Consumer side: the oldest pending snapshot, or nullptr
+    std::shared_ptr<const Snapshot> poll();
+
+private:
+    Solver &solver_;
+    SpscRing<std::shared_ptr<const Snapshot>> ring_;
+    std::thread thread_;
+    std::atomic<bool> stop_, running_;
+    FrameWriter *writer_;
+
+    void run(double t_end, double keyframe_interval, double frame_interval, AbortCheck abort);
+    void record();
+    void publish(bool keyframe, bool last);
+};
+
+#endif // SOLVERWORKER_H
@@ -0,0 +1,79 @@
+#include "spectral.h"
+
+#include <cmath>
+
+SpectralSolver::SpectralSolver(const Parameters &param)
+    : param_(param), dst_(param.get_nx()-2), coefficients_(param.get_nx()-2), work_(param.get_nx()-2),
+      left_(0.0), right_(0.0), state_(param.get_nx()), t_cur_(0.0)
+{}
+
+void SpectralSolver::init(InitialProfile profile)
+{
+    double ampl = amplitude(profile, param_.get_dx());
+
+    for (decltype(state_.size()) i = 0; i < state_.size(); ++i)
+        state_[i] = initial((double(i) - state_.size()/2) * param_.get_dx(), profile, ampl);
+
+    init(state_.data());
+}
+
+void SpectralSolver::init(const double *state)
+{
+    const std::size_t n = state_.size();
+    left_ = state[0];
+    right_ = state[n-1];
+
+    for (std::size_t i = 1; i+1 < n; ++i)
+        work_[i-1] = state[i] - (left_ + (right_ - left_) * double(i) / (n-1));
+    dst_.transform(work_.data(), coefficients_.data());
+
+    // Fold the normalization of the inverse transform into the coefficients
+    for (double &c: coefficients_)
+        c *= 2.0 / (n-1);
+
+    state_.assign(state, state + n);
+    t_cur_ = 0.0;
+}
+
+void SpectralSolver::advance_to(double t)
+{
+    const std::size_t n = state_.size();
+    const double k = M_PI / (param_.get_dx() * (n-1));
+
+    for (std::size_t m = 0; m < coefficients_.size(); ++m)
+        work_[m] = coefficients_[m] * std::exp(-k*k * double(m+1)*double(m+1) * t);
+    dst_.transform(work_.data(), &state_[1]);
+
+    for (std::size_t i = 1; i+1 < n; ++i)
+        state_[i] += left_ + (right_ - left_) * double(i) / (n-1);
+    state_[0] = left_;
+    state_[n-1] = right_;
+
+    t_cur_ = t;
+}
+
+const Parameters &SpectralSolver::get_parameters() const
+{
+    return param_;
+}
+
+const AlignedVector &SpectralSolver::get_state() const
+{
+    return state_;
+}
+
+double SpectralSolver::get_t() const
+{
+    return t_cur_;
+}
+
+void sine_spectrum(const SineTransform &dst, const double *state, std::vector<double> &work, std::vector<double> &res)
+{
+    const std::size_t n = dst.size() + 2;
+    work.resize(n-2);
+    res.resize(n-2);
+    for (std::size_t i = 1; i+1 < n; ++i)
+        work[i-1] = state[i] - (state[0] + (state[n-1] - state[0]) * double(i) / (n-1));
+
+    dst.transform(work.data(), res.data());
+}
@@ -0,0 +1,46 @@
+#ifndef SPECTRAL_H
+#define SPECTRAL_H
+
+#include <cstdint>
+#include <vector>
+
+#include "aligned.h"
+#include "fft.h"
+#include "heat.h"
+#include "parameters.h"
+
+// Exact solution of u_t = u_xx on the solver grid with both ends held at their
+// initial values. The linear profile through the ends is stationary, the rest
+// is expanded in the Dirichlet sine modes sin(k_m (x + L/2)), k_m = pi m/L,
+// each of which decays as exp(-k_m^2 t). Any time is reached with one sine
+// transform, O(n log n) and independent of t, so this is the reference the
+// time-stepping schemes are measured against.
+class SpectralSolver
+{
+public:
+    explicit SpectralSolver(const Parameters &param);
+
+    void init(InitialProfile profile);
+    void init(const double *state);
+    void advance_to(double t);
+
+    const Parameters &get_parameters() const;
+    const AlignedVector &get_state() const;
+    double get_t() const;
+
+private:
+    Parameters param_;
+    SineTransform dst_;
+    std::vector<double> coefficients_, work_;
+    double left_, right_;
+    AlignedVector state_;
+    double t_cur_;
+};
+
+// Sine coefficients of the interior of state after removing the linear
+// profile through the ends, dst.size() values ordered by wavenumber. state
+// holds dst.size()+2 values; work and res are resized only if they are too
+// small, so repeated calls with the same transform do not allocate.
+void sine_spectrum(const SineTransform &dst, const double *state, std::vector<double> &work, std::vector<double> &res);
+
+#endif // SPECTRAL_H
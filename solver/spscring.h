@@ -0,0 +1,75 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Bounded lock-free ring for exactly one producer thread and one consumer
+// thread. Capacity is rounded up to a power of two.
+template <typename T>
+class SpscRing
+{
+public:
+    explicit SpscRing(std::size_t capacity);
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    std::size_t capacity() const;
+
+    // Producer side, returns false if the ring is full
+    bool push(T value);
+    // Consumer side, returns false if the ring is empty
+    bool pop(T &value);
+
+private:
+    std::vector<T> slots_;
+    std::size_t mask_;
+    alignas(64) std::atomic<std::size_t> head_;
+    alignas(64) std::atomic<std::size_t> tail_;
+};
+
+template <typename T>
+SpscRing<T>::SpscRing(std::size_t capacity)
+    : head_(0), tail_(0)
+{
+    std::size_t size = 1;
+    while (size < capacity)
+        size *= 2;
+    slots_.resize(size);
+    mask_ = size - 1;
+}
+
+template <typename T>
+std::size_t SpscRing<T>::capacity() const
+{
+    return slots_.size();
+}
+
+template <typename T>
+bool SpscRing<T>::push(T value)
+{
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == slots_.size())
+        return false;
+
+    slots_[tail & mask_] = std::move(value);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+bool SpscRing<T>::pop(T &value)
+{
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire))
+        return false;
+
+    value = std::move(slots_[head & mask_]);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+#endif // SPSCRING_H
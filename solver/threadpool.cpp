@@ -0,0 +1,90 @@
+#include "threadpool.h"
+
+#include <algorithm>
+
+Barrier::Barrier(int count)
+    : count_(count), waiting_(0), generation_(0)
+{}
+
+void Barrier::wait()
+{
+    const unsigned generation = generation_.load(std::memory_order_acquire);
+    if (waiting_.fetch_add(1, std::memory_order_acq_rel) == count_-1)
+    {
+        waiting_.store(0, std::memory_order_relaxed);
+        generation_.fetch_add(1, std::memory_order_release);
+        return;
+    }
+
+    for (int spins = 0; generation_.load(std::memory_order_acquire) == generation; ++spins)
+        if (spins > 1000)
+            std::this_thread::yield();
+}
+
+ThreadPool::ThreadPool(int threads)
+    : size_(std::max(threads, 1)), job_(nullptr), generation_(0), pending_(0), stop_(false), barrier_(size_)
+{
+    for (int i = 1; i < size_; ++i)
+        workers_.emplace_back(&ThreadPool::work, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_.notify_all();
+    for (auto &worker: workers_)
+        worker.join();
+}
+
+int ThreadPool::size() const
+{
+    return size_;
+}
+
+void ThreadPool::run(const std::function<void(int)> &job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &job;
+        pending_ = size_ - 1;
+        ++generation_;
+    }
+    start_.notify_all();
+
+    job(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this]() { return pending_ == 0; });
+    job_ = nullptr;
+}
+
+void ThreadPool::barrier()
+{
+    barrier_.wait();
+}
+
+void ThreadPool::work(int index)
+{
+    unsigned seen = 0;
+    for (;;)
+    {
+        const std::function<void(int)> *job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_.wait(lock, [this, seen]() { return stop_ || generation_ != seen; });
+            if (stop_)
+                return;
+            seen = generation_;
+            job = job_;
+        }
+
+        (*job)(index);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--pending_ == 0)
+            done_.notify_one();
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Sense-reversing spin barrier. Threads spin briefly and then yield, so
+// per-step synchronisation stays cheap without burning idle cores for long.
+class Barrier
+{
+public:
+    explicit Barrier(int count);
+
+    void wait();
+
+private:
+    const int count_;
+    std::atomic<int> waiting_;
+    std::atomic<unsigned> generation_;
+};
+
+// Persistent fork-join pool: run() executes a job on every thread of the pool
+// (the calling thread acts as thread 0) and returns when all of them are done.
+// Workers are created once and sleep between jobs.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(int threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int size() const;
+    void run(const std::function<void(int)> &job);
+
+    // Synchronises all threads of the pool from inside a job
+    void barrier();
+
+private:
+    int size_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_, done_;
+    const std::function<void(int)> *job_;
+    unsigned generation_;
+    int pending_;
+    bool stop_;
+    Barrier barrier_;
+
+    void work(int index);
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,353 @@
+#include "tridiagonal.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+Tridiagonal::Tridiagonal()
+    : n_(0), off_(0.0), diag_(1.0)
+{}
+
+// Out of the constructor: GCC ignores the optimize attribute on constructors
+HEAT_NO_CONTRACT
+static void factorize(std::size_t n, double off, double diag, double *inv_denominator)
+{
+    double u = 0.0;
+    inv_denominator[0] = 0.0;
+    for (std::size_t i = 1; i < n-1; ++i)
+    {
+        inv_denominator[i] = 1.0 / (off * u - diag);
+        u = -off * inv_denominator[i];
+    }
+}
+
+Tridiagonal::Tridiagonal(std::size_t n, double off, double diag)
+    : n_(n), off_(off), diag_(diag), inv_denominator_(n-1)
+{
+    factorize(n_, off_, diag_, inv_denominator_.data());
+}
+
+std::size_t Tridiagonal::size() const
+{
+    return n_;
+}
+
+double Tridiagonal::get_off() const
+{
+    return off_;
+}
+
+double Tridiagonal::get_diag() const
+{
+    return diag_;
+}
+
+HEAT_NO_CONTRACT
+void Tridiagonal::backward(const double *v, double last, double *x) const
+{
+    x[n_-1] = last;
+    for (std::size_t i = n_-2; i > 0; --i)
+        x[i] = (-off_ * inv_denominator_[i]) * x[i+1] + v[i];
+    x[0] = v[0];
+}
+
+HEAT_NO_CONTRACT
+double Tridiagonal::backward_peak(const double *v, double last, double *x) const
+{
+    x[n_-1] = last;
+    double peak = std::abs(last), check = last - last;
+    for (std::size_t i = n_-2; i > 0; --i)
+    {
+        x[i] = (-off_ * inv_denominator_[i]) * x[i+1] + v[i];
+        peak = std::max(peak, std::abs(x[i]));
+        check += x[i] - x[i];
+    }
+    x[0] = v[0];
+    peak = std::max(peak, std::abs(x[0]));
+    check += x[0] - x[0];
+    return (check == 0.0) ? peak : std::numeric_limits<double>::infinity();
+}
+
+HEAT_NO_CONTRACT
+void Tridiagonal::solve(const double *rhs, double *x) const
+{
+    forward(rhs[0], [rhs](std::size_t i) { return rhs[i]; }, x);
+    backward(x, rhs[n_-1], x);
+}
+
+// Fixed-width kernels of solve_columns(): the constant trip count and
+// restrict-qualified rows let the compiler emit straight vector code at -O2
+constexpr std::size_t kColumnLanes = 8;
+
+static inline void forward_lanes(const double *__restrict prev, double *__restrict v, double off, double inv)
+{
+    for (std::size_t c = 0; c < kColumnLanes; ++c)
+        v[c] = (-v[c] - off * prev[c]) * inv;
+}
+
+static inline void backward_lanes(const double *__restrict next, double *__restrict v, double u)
+{
+    for (std::size_t c = 0; c < kColumnLanes; ++c)
+        v[c] = u * next[c] + v[c];
+}
+
+void Tridiagonal::solve_columns(double *x, std::size_t count, std::size_t stride) const
+{
+    const std::size_t body = count - count % kColumnLanes;
+
+    for (std::size_t i = 1; i < n_-1; ++i)
+    {
+        const double *prev = x + (i-1)*stride;
+        double *v = x + i*stride;
+        const double inv = inv_denominator_[i];
+        std::size_t c = 0;
+        for (; c < body; c += kColumnLanes)
+            forward_lanes(prev + c, v + c, off_, inv);
+        for (; c < count; ++c)
+            v[c] = (-v[c] - off_ * prev[c]) * inv;
+    }
+
+    for (std::size_t i = n_-2; i > 0; --i)
+    {
+        const double *next = x + (i+1)*stride;
+        double *v = x + i*stride;
+        const double u = -off_ * inv_denominator_[i];
+        std::size_t c = 0;
+        for (; c < body; c += kColumnLanes)
+            backward_lanes(next + c, v + c, u);
+        for (; c < count; ++c)
+            v[c] = u * next[c] + v[c];
+    }
+}
+
+void Tridiagonal::solve_rows(double *x, std::size_t count, std::size_t stride) const
+{
+    constexpr std::size_t kGroup = 8;
+
+    std::size_t r = 0;
+    for (; r + kGroup <= count; r += kGroup)
+    {
+        double *row = x + r*stride;
+        for (std::size_t i = 1; i < n_-1; ++i)
+        {
+            const double inv = inv_denominator_[i];
+            for (std::size_t g = 0; g < kGroup; ++g)
+                row[g*stride + i] = (-row[g*stride + i] - off_ * row[g*stride + i-1]) * inv;
+        }
+        for (std::size_t i = n_-2; i > 0; --i)
+        {
+            const double u = -off_ * inv_denominator_[i];
+            for (std::size_t g = 0; g < kGroup; ++g)
+                row[g*stride + i] = u * row[g*stride + i+1] + row[g*stride + i];
+        }
+    }
+    for (; r < count; ++r)
+        solve(x + r*stride, x + r*stride);
+}
+
+VariableTridiagonal::VariableTridiagonal()
+    : n_(0)
+{}
+
+VariableTridiagonal::VariableTridiagonal(std::size_t n)
+    : n_(n), coupling_(n, 0.0), upper_(n, 0.0), inv_denominator_(n, 0.0)
+{}
+
+std::size_t VariableTridiagonal::size() const
+{
+    return n_;
+}
+
+void VariableTridiagonal::factorize(const double *face, double scale)
+{
+    // x[i] = v[i] + upper[i]*x[i+1] with v[i] = (rhs[i] + c[i]*v[i-1]) / denominator[i]
+    double w = 0.0;
+    for (std::size_t i = 1; i < n_-1; ++i)
+    {
+        coupling_[i] = scale * face[i];
+        const double next = scale * face[i+1];
+        inv_denominator_[i] = 1.0 / (1.0 + coupling_[i] + next - coupling_[i] * w);
+        w = upper_[i] = next * inv_denominator_[i];
+    }
+}
+
+void VariableTridiagonal::backward(const double *v, double last, double *x) const
+{
+    x[n_-1] = last;
+    for (std::size_t i = n_-2; i > 0; --i)
+        x[i] = v[i] + upper_[i] * x[i+1];
+    x[0] = v[0];
+}
+
+GeneralTridiagonal::GeneralTridiagonal()
+    : n_(0)
+{}
+
+GeneralTridiagonal::GeneralTridiagonal(const std::vector<double> &lower, const std::vector<double> &diag, const std::vector<double> &upper)
+    : n_(diag.size()), lower_(lower), upper_(n_), inv_denominator_(n_)
+{
+    // x[i] = v[i] - upper[i]*x[i+1], upper[] holds the eliminated coefficients
+    double w = 0.0;
+    for (std::size_t i = 0; i < n_; ++i)
+    {
+        inv_denominator_[i] = 1.0 / (diag[i] - (i > 0 ? lower_[i] * w : 0.0));
+        w = upper_[i] = (i+1 < n_) ? upper[i] * inv_denominator_[i] : 0.0;
+    }
+}
+
+std::size_t GeneralTridiagonal::size() const
+{
+    return n_;
+}
+
+void GeneralTridiagonal::backward(double *x) const
+{
+    for (std::size_t i = n_-1; i-- > 0; )
+        x[i] -= upper_[i] * x[i+1];
+}
+
+CyclicTridiagonal::CyclicTridiagonal()
+    : n_(0), gamma_(1.0), corner_(0.0), inv_scale_(1.0)
+{}
+
+CyclicTridiagonal::CyclicTridiagonal(std::size_t n, double off, double diag)
+    : n_(n), gamma_(-diag), corner_(-off), z_(n, 0.0)
+{
+    // u = (gamma, 0, ..., 0, corner), v = (1, 0, ..., 0, corner/gamma)
+    std::vector<double> lower(n_, -off), main(n_, diag), upper(n_, -off);
+    main[0] -= gamma_;
+    main[n_-1] -= corner_ * corner_ / gamma_;
+    open_ = GeneralTridiagonal(lower, main, upper);
+
+    z_[0] = gamma_;
+    z_[n_-1] = corner_;
+    const double *u = z_.data();
+    open_.forward([u](std::size_t i) { return u[i]; }, z_.data());
+    open_.backward(z_.data());
+
+    inv_scale_ = 1.0 / (1.0 + z_[0] + corner_ / gamma_ * z_[n_-1]);
+}
+
+std::size_t CyclicTridiagonal::size() const
+{
+    return n_;
+}
+
+constexpr double PartitionedTridiagonal::kResponseCutoff;
+
+PartitionedTridiagonal::PartitionedTridiagonal()
+    : n_(0), off_(0.0), diag_(1.0), parts_(0)
+{}
+
+PartitionedTridiagonal::PartitionedTridiagonal(std::size_t n, double off, double diag, int parts)
+    : n_(n), off_(off), diag_(diag)
+{
+    // Every chunk needs at least one node next to its separator
+    parts_ = static_cast<int>(std::max<std::size_t>(std::min<std::size_t>(parts, (n_-1) / 2), 1));
+
+    separators_.resize(parts_+1);
+    for (int p = 0; p < parts_; ++p)
+        separators_[p] = (n_-1) * p / parts_;
+    separators_[parts_] = n_-1;
+
+    std::size_t longest = 0;
+    for (int p = 0; p < parts_; ++p)
+        longest = std::max(longest, separators_[p+1] - separators_[p] - 1);
+    inv_denominator_.resize(longest+1);
+    double u = 0.0;
+    inv_denominator_[0] = 0.0;
+    for (std::size_t i = 1; i <= longest; ++i)
+    {
+        inv_denominator_[i] = 1.0 / (off_ * u - diag_);
+        u = -off_ * inv_denominator_[i];
+    }
+
+    // Responses of each chunk to a unit value on its left and right separator
+    left_response_.resize(parts_);
+    right_response_.resize(parts_);
+    std::vector<double> rhs(n_, 0.0), x(n_);
+    for (int p = 0; p < parts_; ++p)
+    {
+        const std::size_t first = separators_[p] + 1;
+        const std::size_t last = separators_[p+1];
+
+        sweep(first, last, 1.0, 0.0, rhs.data(), x.data());
+        std::size_t len = 0;
+        while (len < last - first && std::abs(x[first+len]) > kResponseCutoff)
+            ++len;
+        left_response_[p].assign(x.begin() + first, x.begin() + first + len);
+
+        sweep(first, last, 0.0, 1.0, rhs.data(), x.data());
+        len = 0;
+        while (len < last - first && std::abs(x[last-1-len]) > kResponseCutoff)
+            ++len;
+        right_response_[p].resize(len);
+        for (std::size_t j = 0; j < len; ++j)
+            right_response_[p][j] = x[last-1-j];
+    }
+
+    // The separator system only depends on the coefficients: factorize it once
+    reduced_a_.assign(parts_, 0.0);
+    reduced_c_.assign(parts_, 0.0);
+    reduced_inv_denominator_.assign(parts_, 0.0);
+    reduced_v_.assign(parts_, 0.0);
+    double c_prev = 0.0;
+    for (int p = 1; p < parts_; ++p)
+    {
+        const std::size_t k = separators_[p];
+        const double a = -off_ * left_response(p-1, k-1);
+        const double b = diag_ - off_ * right_response(p-1, k-1) - off_ * left_response(p, k+1);
+        const double c = -off_ * right_response(p, k+1);
+
+        reduced_a_[p] = a;
+        reduced_inv_denominator_[p] = 1.0 / (b - a * c_prev);
+        reduced_c_[p] = c_prev = c * reduced_inv_denominator_[p];
+    }
+}
+
+std::size_t PartitionedTridiagonal::size() const
+{
+    return n_;
+}
+
+int PartitionedTridiagonal::parts() const
+{
+    return parts_;
+}
+
+void PartitionedTridiagonal::correct_part(int part, double *x) const
+{
+    const std::size_t first = separators_[part] + 1;
+    const std::size_t last = separators_[part+1];
+    const double left = x[first-1];
+    const double right = x[last];
+
+    const std::vector<double> &l = left_response_[part];
+    for (std::size_t j = 0; j < l.size(); ++j)
+        x[first+j] += left * l[j];
+    const std::vector<double> &r = right_response_[part];
+    for (std::size_t j = 0; j < r.size(); ++j)
+        x[last-1-j] += right * r[j];
+}
+
+void PartitionedTridiagonal::sweep(std::size_t first, std::size_t last, double left, double right, const double *rhs, double *x) const
+{
+    double v = left;
+    for (std::size_t i = first; i < last; ++i)
+        x[i] = v = (-rhs[i] - off_ * v) * inv_denominator_[i - first + 1];
+    double next = right;
+    for (std::size_t i = last; i-- > first; )
+        x[i] = next = (-off_ * inv_denominator_[i - first + 1]) * next + x[i];
+}
+
+double PartitionedTridiagonal::left_response(int part, std::size_t i) const
+{
+    const std::size_t j = i - (separators_[part] + 1);
+    return (j < left_response_[part].size()) ? left_response_[part][j] : 0.0;
+}
+
+double PartitionedTridiagonal::right_response(int part, std::size_t i) const
+{
+    const std::size_t j = (separators_[part+1] - 1) - i;
+    return (j < right_response_[part].size()) ? right_response_[part][j] : 0.0;
+}
@@ -0,0 +1,233 @@
+#ifndef TRIDIAGONAL_H
+#define TRIDIAGONAL_H
+
+#include <cstddef>
+#include <vector>
+
+#include "compiler.h"
+
+// Constant-coefficient tridiagonal system with Dirichlet ends:
+//     x[0] = rhs[0],  -off*x[i-1] + diag*x[i] - off*x[i+1] = rhs[i],  x[n-1] = rhs[n-1].
+// The Thomas forward-sweep coefficients depend only on (off, diag), so they are
+// computed once in the constructor and every solve is a division-free
+// forward substitution followed by the back substitution. Only the inverse
+// denominators are stored, u[i] = -off/denominator[i] is recomputed on the fly.
+// forward() and backward() may share one buffer for v and x. Nothing is
+// FMA-contracted, so BatchSolver reproduces the sweeps bit for bit.
+class Tridiagonal
+{
+public:
+    Tridiagonal();
+    Tridiagonal(std::size_t n, double off, double diag);
+
+    std::size_t size() const;
+    double get_off() const;
+    double get_diag() const;
+
+    // rhs(i) is only evaluated for interior nodes, the boundary values are passed explicitly
+    template <typename Rhs>
+    void forward(double first, Rhs rhs, double *v) const;
+    void backward(const double *v, double last, double *x) const;
+    // backward() that also returns the largest |x[i]|, +inf once any x[i] is
+    // not finite; the max rides along the serial recurrence for free
+    double backward_peak(const double *v, double last, double *x) const;
+    void solve(const double *rhs, double *x) const;
+    // Solves count systems side by side in place, element i of system c
+    // sitting at x[c + i*stride] and holding the right-hand side on entry.
+    // The inner loops run across the systems, so they are contiguous and vectorize.
+    void solve_columns(double *x, std::size_t count, std::size_t stride) const;
+    // Same for systems stored along rows, element i of system r at
+    // x[r*stride + i]. Groups of rows are swept together so that their
+    // independent recurrences overlap instead of waiting on each other.
+    void solve_rows(double *x, std::size_t count, std::size_t stride) const;
+
+private:
+    std::size_t n_;
+    double off_, diag_;
+    std::vector<double> inv_denominator_;
+};
+
+// Tridiagonal system of a variable-coefficient diffusion step with Dirichlet ends:
+//     x[0] = rhs[0],  -c[i]*x[i-1] + (1 + c[i] + c[i+1])*x[i] - c[i+1]*x[i+1] = rhs[i],
+//     x[n-1] = rhs[n-1],
+// where c[i] = scale*face[i] couples nodes i-1 and i. factorize() computes the
+// forward-sweep coefficients for one set of couplings, so a fixed conductivity
+// field is factorized once and every solve is again division free.
+class VariableTridiagonal
+{
+public:
+    VariableTridiagonal();
+    explicit VariableTridiagonal(std::size_t n);
+
+    std::size_t size() const;
+    // face[i] for i in [1, n), face[0] is ignored
+    void factorize(const double *face, double scale);
+
+    template <typename Rhs>
+    void forward(double first, Rhs rhs, double *v) const;
+    void backward(const double *v, double last, double *x) const;
+
+private:
+    std::size_t n_;
+    std::vector<double> coupling_, upper_, inv_denominator_;
+};
+
+// General tridiagonal system, row i reading
+//     lower[i]*x[i-1] + diag[i]*x[i] + upper[i]*x[i+1] = rhs[i]
+// (lower[0] and upper[n-1] unused). Factorized once like Tridiagonal, for
+// boundary rows that do not fit the constant-coefficient form.
+class GeneralTridiagonal
+{
+public:
+    GeneralTridiagonal();
+    GeneralTridiagonal(const std::vector<double> &lower, const std::vector<double> &diag, const std::vector<double> &upper);
+
+    std::size_t size() const;
+
+    // rhs(i) is evaluated for every node, backward() then works in place on v
+    template <typename Rhs>
+    void forward(Rhs rhs, double *v) const;
+    void backward(double *x) const;
+
+private:
+    std::size_t n_;
+    std::vector<double> lower_, upper_, inv_denominator_;
+};
+
+// Constant-coefficient system closed into a ring, the periodic counterpart of
+// Tridiagonal:
+//     -off*x[i-1] + diag*x[i] - off*x[i+1] = rhs[i],  indices modulo n.
+// Sherman-Morrison: the ring is an open tridiagonal matrix B plus the rank
+// one corner term u*v^T, so x = y - (v.y)/(1 + v.z) * z with B y = rhs and
+// B z = u. z and 1/(1 + v.z) depend on the matrix only and are precomputed,
+// a solve is one Thomas sweep plus one axpy.
+class CyclicTridiagonal
+{
+public:
+    CyclicTridiagonal();
+    CyclicTridiagonal(std::size_t n, double off, double diag);
+
+    std::size_t size() const;
+    template <typename Rhs>
+    void solve(Rhs rhs, double *x) const;
+
+private:
+    std::size_t n_;
+    double gamma_, corner_, inv_scale_;
+    GeneralTridiagonal open_;
+    std::vector<double> z_;
+};
+
+// Partitioned Thomas algorithm for the same system as Tridiagonal. The interior
+// is cut into `parts` chunks separated by single separator nodes:
+//   1. solve_part() solves every chunk independently with zero boundary values,
+//   2. solve_interface() solves the small tridiagonal system for the separator
+//      values that couples neighbouring chunks,
+//   3. correct_part() adds the precomputed chunk responses to unit boundary
+//      values, scaled by the separator values.
+// Steps 1 and 3 touch disjoint nodes and can run on different threads.
+// The responses decay exponentially away from the chunk ends and are only
+// stored until they drop below kResponseCutoff.
+class PartitionedTridiagonal
+{
+public:
+    PartitionedTridiagonal();
+    PartitionedTridiagonal(std::size_t n, double off, double diag, int parts);
+
+    std::size_t size() const;
+    int parts() const;
+
+    // part is in [0, parts()), rhs(i) is evaluated for the chunk nodes only
+    template <typename Rhs>
+    void solve_part(int part, Rhs rhs, double *x) const;
+    // Evaluates rhs(i) at the separators and at both boundary nodes
+    template <typename Rhs>
+    void solve_interface(Rhs rhs, double *x);
+    void correct_part(int part, double *x) const;
+
+private:
+    static constexpr double kResponseCutoff = 1e-20;
+
+    std::size_t n_;
+    double off_, diag_;
+    int parts_;
+    std::vector<std::size_t> separators_;
+    std::vector<double> inv_denominator_;
+    std::vector<std::vector<double>> left_response_, right_response_;
+    std::vector<double> reduced_a_, reduced_c_, reduced_inv_denominator_, reduced_v_;
+
+    void sweep(std::size_t first, std::size_t last, double left, double right, const double *rhs, double *x) const;
+    double left_response(int part, std::size_t i) const;
+    double right_response(int part, std::size_t i) const;
+};
+
+template <typename Rhs>
+HEAT_NO_CONTRACT
+void Tridiagonal::forward(double first, Rhs rhs, double *v) const
+{
+    v[0] = first;
+    for (std::size_t i = 1; i < n_-1; ++i)
+        v[i] = (-rhs(i) - off_ * v[i-1]) * inv_denominator_[i];
+}
+
+template <typename Rhs>
+void VariableTridiagonal::forward(double first, Rhs rhs, double *v) const
+{
+    v[0] = first;
+    for (std::size_t i = 1; i < n_-1; ++i)
+        v[i] = (rhs(i) + coupling_[i] * v[i-1]) * inv_denominator_[i];
+}
+
+template <typename Rhs>
+void GeneralTridiagonal::forward(Rhs rhs, double *v) const
+{
+    v[0] = rhs(0) * inv_denominator_[0];
+    for (std::size_t i = 1; i < n_; ++i)
+        v[i] = (rhs(i) - lower_[i] * v[i-1]) * inv_denominator_[i];
+}
+
+template <typename Rhs>
+void CyclicTridiagonal::solve(Rhs rhs, double *x) const
+{
+    open_.forward(rhs, x);
+    open_.backward(x);
+
+    const double f = (x[0] + corner_ / gamma_ * x[n_-1]) * inv_scale_;
+    for (std::size_t i = 0; i < n_; ++i)
+        x[i] -= f * z_[i];
+}
+
+template <typename Rhs>
+void PartitionedTridiagonal::solve_part(int part, Rhs rhs, double *x) const
+{
+    const std::size_t first = separators_[part] + 1;
+    const std::size_t last = separators_[part+1];
+
+    double v = 0.0;
+    for (std::size_t i = first; i < last; ++i)
+        x[i] = v = (-rhs(i) - off_ * v) * inv_denominator_[i - first + 1];
+    double next = 0.0;
+    for (std::size_t i = last; i-- > first; )
+        x[i] = next = (-off_ * inv_denominator_[i - first + 1]) * next + x[i];
+}
+
+template <typename Rhs>
+void PartitionedTridiagonal::solve_interface(Rhs rhs, double *x)
+{
+    x[0] = rhs(0);
+    x[n_-1] = rhs(n_-1);
+
+    // Forward sweep over the separators 1..parts-1, the outer ends are known
+    double v = x[0];
+    for (int p = 1; p < parts_; ++p)
+    {
+        const std::size_t k = separators_[p];
+        const double f = rhs(k) + off_ * (x[k-1] + x[k+1]);
+        v = reduced_v_[p] = (f - reduced_a_[p] * v) * reduced_inv_denominator_[p];
+    }
+    double next = x[n_-1];
+    for (int p = parts_-1; p > 0; --p)
+        x[separators_[p]] = next = reduced_v_[p] - reduced_c_[p] * next;
+}
+
+#endif // TRIDIAGONAL_H